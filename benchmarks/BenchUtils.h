@@ -0,0 +1,103 @@
+#ifndef GRAPHIR_BENCHMARKS_BENCHUTILS_H
+#define GRAPHIR_BENCHMARKS_BENCHUTILS_H
+/// Some utilities only for benchmark programs.
+/// Note that this header replaces the global allocation
+/// functions, so it should only be included by exactly one
+/// translation unit of each benchmark executable.
+#include "graphir/Graph/Graph.h"
+#include "graphir/Graph/NodeUtils.h"
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+namespace graphir {
+namespace bench {
+struct AllocStats {
+  size_t NumAllocs = 0U;
+  size_t NumBytes = 0U;
+};
+inline AllocStats GlobalAllocStats;
+
+/// Records the heap allocations happened within its lifetime
+struct AllocScope {
+  AllocScope() : Begin(GlobalAllocStats) {}
+
+  size_t allocs() const {
+    return GlobalAllocStats.NumAllocs - Begin.NumAllocs;
+  }
+  size_t bytes() const {
+    return GlobalAllocStats.NumBytes - Begin.NumBytes;
+  }
+
+private:
+  AllocStats Begin;
+};
+
+struct Timer {
+  using clock = std::chrono::steady_clock;
+
+  Timer() : Begin(clock::now()) {}
+
+  void reset() { Begin = clock::now(); }
+
+  // elapsed time in milliseconds
+  double elapsed() const {
+    std::chrono::duration<double, std::milli> D = clock::now() - Begin;
+    return D.count();
+  }
+
+private:
+  clock::time_point Begin;
+};
+
+/// Build a straight-line function with \p NumStmts accumulating
+/// statements. Each statement adds a constant-foldable product
+/// onto the argument-dependent accumulator, so reducers have both
+/// foldable and non-foldable nodes to chew on.
+inline SubGraph BuildSyntheticFunction(Graph& G, const std::string& Name,
+                                       unsigned NumStmts) {
+  auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName(Name)
+               .AddParameter(Arg)
+               .Build();
+  Node* Acc = Arg;
+  for(auto i = 0U; i < NumStmts; ++i) {
+    auto* C1 = NodeBuilder<IrOpcode::ConstantInt>(&G, i % 64).Build();
+    auto* C2 = NodeBuilder<IrOpcode::ConstantInt>(&G, (i * 7) % 64 + 1)
+               .Build();
+    auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+                 .LHS(C1).RHS(C2).Build();
+    Acc = NodeBuilder<IrOpcode::BinAdd>(&G)
+          .LHS(Acc).RHS(Prod).Build();
+  }
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Acc).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  SubGraph SG(End);
+  G.AddSubRegion(SG);
+  (void) NodeBuilder<IrOpcode::FunctionStub>(&G, SG).Build();
+  return SG;
+}
+
+inline void BuildSyntheticModule(Graph& G, unsigned NumFuncs,
+                                 unsigned NumStmts) {
+  for(auto i = 0U; i < NumFuncs; ++i)
+    (void) BuildSyntheticFunction(G, "func" + std::to_string(i), NumStmts);
+}
+} // end namespace bench
+} // end namespace graphir
+
+void* operator new(std::size_t Size) {
+  graphir::bench::GlobalAllocStats.NumAllocs += 1;
+  graphir::bench::GlobalAllocStats.NumBytes += Size;
+  if(void* Ptr = std::malloc(Size ? Size : 1)) return Ptr;
+  throw std::bad_alloc();
+}
+void operator delete(void* Ptr) noexcept { std::free(Ptr); }
+void operator delete(void* Ptr, std::size_t) noexcept { std::free(Ptr); }
+#endif
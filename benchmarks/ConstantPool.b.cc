@@ -0,0 +1,82 @@
+/// Measure the constant pools: parsing constant-heavy source code,
+/// raw ConstantInt lookups, and Peephole folding which creates lots
+/// of new ConstantInt nodes.
+#include "BenchUtils.h"
+#include "graphir/Frontend/Parser.h"
+#include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/Reductions/Peephole.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace graphir;
+
+namespace {
+// each function is a long sequence of assignments
+// with distinct constants
+void GenerateSource(std::ostream& OS, unsigned NumFuncs,
+                    unsigned NumStmts) {
+  OS << "main\n";
+  for(auto i = 0U; i < NumFuncs; ++i) {
+    OS << "function f" << i << "(a);\n"
+       << "var x;\n"
+       << "{\n"
+       << "  let x <- a";
+    for(auto j = 0U; j < NumStmts; ++j) {
+      OS << ";\n  let x <- x + " << (i * NumStmts + j) % 100000
+         << " * " << j % 97;
+    }
+    OS << ";\n  return x\n};\n";
+  }
+  OS << "{ call f0(1) }.\n";
+}
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 100U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 500U;
+
+  double ParseTime, LookupTime, FoldTime;
+  size_t NumConsts, NumFoldConsts, NumLookups = 0U;
+  {
+    std::stringstream SS;
+    GenerateSource(SS, NumFuncs, NumStmts);
+    Graph G;
+    Parser P(SS, G);
+    bench::Timer T;
+    if(!P.Parse()) {
+      std::cerr << "Failed to parse the generated source\n";
+      return 1;
+    }
+    ParseTime = T.elapsed();
+    NumConsts = G.getNumConstNumber();
+
+    // half of the lookups hit existing constants
+    T.reset();
+    size_t Sum = 0U;
+    for(auto i = 0U; i < 20U; ++i) {
+      for(auto V = 0; V < 200000; V += 2) {
+        Sum += NodeBuilder<IrOpcode::ConstantInt>(&G, V).Build() != nullptr;
+        ++NumLookups;
+      }
+    }
+    LookupTime = T.elapsed();
+    (void) Sum;
+  }
+  {
+    Graph G;
+    bench::BuildSyntheticModule(G, NumFuncs, NumStmts * 2);
+    bench::Timer T;
+    GraphReducer::RunWithEditor<PeepholeReducer>(G);
+    FoldTime = T.elapsed();
+    NumFoldConsts = G.getNumConstNumber();
+  }
+
+  std::cout << "constants after parsing:   " << NumConsts << "\n"
+            << "parse time:                " << ParseTime << " ms\n"
+            << "ConstantInt lookups:       " << NumLookups << "\n"
+            << "lookup time:               " << LookupTime << " ms\n"
+            << "constants after folding:   " << NumFoldConsts << "\n"
+            << "peephole time:             " << FoldTime << " ms\n";
+  return 0;
+}
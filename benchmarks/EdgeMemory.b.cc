@@ -0,0 +1,61 @@
+/// Measure the memory footprint of a large synthetic graph and
+/// the cost of walking its edges. Build with GRAPHIR_COMPACT_EDGES
+/// on and off to compare pointer edges against 32-bit id edges.
+#include "BenchUtils.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace graphir;
+
+int main(int argc, char** argv) {
+  // roughly 1M nodes by default
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 50U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 10000U;
+
+  Graph G;
+  bench::AllocScope Allocs;
+  bench::Timer T;
+  bench::BuildSyntheticModule(G, NumFuncs, NumStmts);
+  double BuildTime = T.elapsed();
+  size_t HeapBytes = Allocs.bytes(), NumAllocs = Allocs.allocs();
+
+  size_t NumEdges = 0U, Checksum = 0U;
+  T.reset();
+  for(auto i = 0U; i < 10U; ++i) {
+    for(auto NI = G.node_begin(); NI != G.node_end(); ++NI) {
+      auto* N = *NI;
+      for(auto* Input : N->inputs()) {
+        Checksum += Input->getId();
+        ++NumEdges;
+      }
+    }
+  }
+  double InputWalkTime = T.elapsed();
+
+  T.reset();
+  for(auto i = 0U; i < 10U; ++i) {
+    for(auto NI = G.node_begin(); NI != G.node_end(); ++NI)
+      for(auto* Usr : (*NI)->users())
+        Checksum += Usr->getId();
+  }
+  double UserWalkTime = T.elapsed();
+
+  std::cout << "edge representation:  "
+#ifdef GRAPHIR_COMPACT_EDGES
+            << "32-bit node ids\n"
+#else
+            << "node pointers\n"
+#endif
+            << "nodes:                " << G.node_size() << "\n"
+            << "edges:                " << NumEdges / 10U << "\n"
+            << "sizeof(Node):         " << sizeof(Node) << " bytes\n"
+            << "node arena:           "
+            << G.getNodeAllocator().getBytesAllocated() << " bytes\n"
+            << "heap allocations:     " << NumAllocs << "\n"
+            << "heap bytes:           " << HeapBytes << "\n"
+            << "build time:           " << BuildTime << " ms\n"
+            << "input walk (x10):     " << InputWalkTime << " ms\n"
+            << "user walk (x10):      " << UserWalkTime << " ms\n"
+            << "(checksum " << Checksum << ")\n";
+  return 0;
+}
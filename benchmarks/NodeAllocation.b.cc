@@ -0,0 +1,35 @@
+/// Measure the cost of creating and tearing down the nodes of a
+/// large module.
+#include "BenchUtils.h"
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+
+using namespace graphir;
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 200U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 1000U;
+
+  auto G = std::make_unique<Graph>();
+  bench::AllocScope BuildAllocs;
+  bench::Timer T;
+  bench::BuildSyntheticModule(*G, NumFuncs, NumStmts);
+  double BuildTime = T.elapsed();
+  size_t NumAllocs = BuildAllocs.allocs(),
+         NumBytes = BuildAllocs.bytes();
+  size_t NumNodes = G->node_size();
+
+  T.reset();
+  G.reset();
+  double DestroyTime = T.elapsed();
+
+  std::cout << "nodes:            " << NumNodes << "\n"
+            << "heap allocations: " << NumAllocs << "\n"
+            << "  per node:       "
+            << static_cast<double>(NumAllocs) / NumNodes << "\n"
+            << "heap bytes:       " << NumBytes << "\n"
+            << "build time:       " << BuildTime << " ms\n"
+            << "destroy time:     " << DestroyTime << " ms\n";
+  return 0;
+}
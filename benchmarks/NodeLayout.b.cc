@@ -0,0 +1,132 @@
+/// Measure the effect of Graph::Compact on the backend: the same
+/// optimized module is scheduled and register allocated with nodes
+/// left in construction order, and after compacting them into RPO
+/// or BFS order.
+#include "BenchUtils.h"
+#include "graphir/CodeGen/GraphScheduling.h"
+#include "graphir/CodeGen/PostMachineLowering.h"
+#include "graphir/CodeGen/PreMachineLowering.h"
+#include "graphir/CodeGen/RegisterAllocator.h"
+#include "graphir/CodeGen/Targets.h"
+#include "graphir/Frontend/Parser.h"
+#include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/Reductions/CSE.h"
+#include "graphir/Graph/Reductions/MemoryLegalize.h"
+#include "graphir/Graph/Reductions/Peephole.h"
+#include "graphir/Graph/Reductions/ValuePromotion.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace graphir;
+
+namespace {
+// each function is a loop with a long body of
+// accumulations and a branch
+void GenerateSource(std::ostream& OS, unsigned NumFuncs,
+                    unsigned NumStmts) {
+  OS << "main\n";
+  for(auto i = 0U; i < NumFuncs; ++i) {
+    OS << "function f" << i << "(a, b);\n"
+       << "var x, y, n;\n"
+       << "{\n"
+       << "  let x <- a;\n"
+       << "  let y <- b;\n"
+       << "  let n <- 0;\n"
+       << "  while n < a do\n";
+    for(auto j = 0U; j < NumStmts; ++j) {
+      OS << "    let x <- x + y * " << j % 13 + 1 << ";\n"
+         << "    let y <- y - x / " << j % 7 + 1 << ";\n";
+    }
+    OS << "    if x > y then let y <- y + n else let x <- x - n fi;\n"
+       << "    let n <- n + 1\n"
+       << "  od;\n"
+       << "  return x + y\n"
+       << "};\n";
+  }
+  OS << "{ call OutputNum(call f0(1, 2)) }.\n";
+}
+
+struct StageTimes {
+  size_t NumNodes = 0U;
+  double Compact = 0.0, Schedule = 0.0, Lowering = 0.0, RA = 0.0;
+};
+
+bool RunBackend(const std::string& Source, Graph::NodeOrder Order,
+                bool DoCompact, StageTimes& Times) {
+  std::stringstream SS(Source);
+  Graph G;
+  Parser P(SS, G);
+  if(!P.Parse()) return false;
+  GraphReducer::RunWithEditor<ValuePromotion>(G);
+  GraphReducer::RunWithEditor<MemoryLegalize>(G);
+  DLXMemoryLegalize DLXML(G);
+  DLXML.Run();
+  GraphReducer::RunWithEditor<PeepholeReducer>(G);
+  GraphReducer::RunWithEditor<CSEReducer>(G);
+  GraphReducer::RunWithEditor<PreMachineLowering>(G);
+
+  Times.NumNodes = G.node_size();
+  bench::Timer T;
+  if(DoCompact) G.Compact(Order);
+  Times.Compact += T.elapsed();
+
+  T.reset();
+  GraphScheduler Scheduler(G);
+  Scheduler.ComputeScheduledGraph();
+  Times.Schedule += T.elapsed();
+
+  for(auto* FS : Scheduler.schedules()) {
+    T.reset();
+    PostMachineLowering PML(*FS);
+    PML.Run();
+    Times.Lowering += T.elapsed();
+
+    T.reset();
+    LinearScanRegisterAllocator<DLXTargetTraits> RA(*FS);
+    RA.Allocate();
+    Times.RA += T.elapsed();
+  }
+  return true;
+}
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 60U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 300U;
+  unsigned NumRuns = argc > 3? std::atoi(argv[3]) : 3U;
+
+  std::stringstream SS;
+  GenerateSource(SS, NumFuncs, NumStmts);
+  auto Source = SS.str();
+
+  struct {
+    const char* Name;
+    Graph::NodeOrder Order;
+    bool DoCompact;
+  } Configs[] = {
+    {"construction order", Graph::NodeOrder::Unchanged, false},
+    {"compact, RPO", Graph::NodeOrder::RPO, true},
+    {"compact, BFS", Graph::NodeOrder::BFS, true}
+  };
+  for(const auto& C : Configs) {
+    StageTimes Times;
+    for(auto i = 0U; i < NumRuns; ++i) {
+      if(!RunBackend(Source, C.Order, C.DoCompact, Times)) {
+        std::cerr << "Failed to parse the generated source\n";
+        return 1;
+      }
+    }
+    std::cout << C.Name << " (average of " << NumRuns << " runs)\n"
+              << "  nodes:                 " << Times.NumNodes << "\n"
+              << "  compact:               "
+              << Times.Compact / NumRuns << " ms\n"
+              << "  scheduling:            "
+              << Times.Schedule / NumRuns << " ms\n"
+              << "  machine lowering:      "
+              << Times.Lowering / NumRuns << " ms\n"
+              << "  register allocation:   "
+              << Times.RA / NumRuns << " ms\n";
+  }
+  return 0;
+}
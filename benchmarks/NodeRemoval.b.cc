@@ -0,0 +1,86 @@
+/// Measure removing lots of unreachable nodes from a large module,
+/// one by one with Graph::RemoveNode versus marking them dead and
+/// sweeping once with Graph::CollectDeadNodes.
+#include "BenchUtils.h"
+#include "graphir/Graph/GraphReducer.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace graphir;
+
+namespace {
+// chains of nodes that are not reachable from any function
+void BuildGarbage(Graph& G, unsigned NumChains, unsigned ChainLength,
+                  NodeSet* Garbage = nullptr) {
+  for(auto i = 0U; i < NumChains; ++i) {
+    Node* Acc = NodeBuilder<IrOpcode::ConstantInt>(&G, i % 64).Build();
+    for(auto j = 0U; j < ChainLength; ++j) {
+      auto* C = NodeBuilder<IrOpcode::ConstantInt>(&G, j % 64).Build();
+      Acc = NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Acc).RHS(C).Build();
+      if(Garbage) Garbage->insert(Acc);
+    }
+  }
+}
+
+struct NoopReducer {
+  GraphReduction Reduce(Node*) { return GraphReduction(); }
+
+  static constexpr
+  const char* name() { return "noop"; }
+};
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 50U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 1000U;
+
+  double OneByOneTime, SweepTime, TrimTime;
+  size_t NumNodes, NumRemoved;
+  {
+    Graph G;
+    NodeSet Garbage;
+    bench::BuildSyntheticModule(G, NumFuncs, NumStmts);
+    BuildGarbage(G, NumFuncs, NumStmts, &Garbage);
+    NumNodes = G.node_size();
+    NumRemoved = Garbage.size();
+
+    bench::Timer T;
+    for(auto NI = G.node_begin(); NI != G.node_end();) {
+      if(Garbage.count(Graph::GetNodeFromIt(NI)))
+        NI = G.RemoveNode(NI);
+      else
+        ++NI;
+    }
+    OneByOneTime = T.elapsed();
+  }
+  {
+    Graph G;
+    NodeSet Garbage;
+    bench::BuildSyntheticModule(G, NumFuncs, NumStmts);
+    BuildGarbage(G, NumFuncs, NumStmts, &Garbage);
+
+    bench::Timer T;
+    for(auto* N : Garbage)
+      G.MarkNodeDead(N);
+    G.CollectDeadNodes();
+    SweepTime = T.elapsed();
+  }
+  {
+    // the trim phase of GraphReducer
+    Graph G;
+    bench::BuildSyntheticModule(G, NumFuncs, NumStmts);
+    BuildGarbage(G, NumFuncs, NumStmts);
+
+    bench::Timer T;
+    GraphReducer::Run<NoopReducer>(G);
+    TrimTime = T.elapsed();
+  }
+
+  std::cout << "nodes:                   " << NumNodes << "\n"
+            << "nodes removed:           " << NumRemoved << "\n"
+            << "RemoveNode one by one:   " << OneByOneTime << " ms\n"
+            << "mark dead and collect:   " << SweepTime << " ms\n"
+            << "reducer trim (noop run): " << TrimTime << " ms\n";
+  return 0;
+}
@@ -0,0 +1,78 @@
+/// Measure GraphReducer fixpoint runs (runOnFunctionGraph) on a
+/// large module, together with the cost of plain edge walks, and
+/// running Peephole and CSE one after another versus in a single
+/// composite run.
+#include "BenchUtils.h"
+#include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/Reductions/CSE.h"
+#include "graphir/Graph/Reductions/Peephole.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace graphir;
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 100U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 1000U;
+
+  Graph G;
+  bench::BuildSyntheticModule(G, NumFuncs, NumStmts);
+  size_t NumNodes = G.node_size();
+
+  // walk every input and user edge a few times
+  bench::Timer T;
+  size_t NumEdges = 0U;
+  for(auto i = 0; i < 10; ++i) {
+    for(auto* N : llvm::make_range(G.node_begin(), G.node_end())) {
+      for(auto* Input : N->inputs())
+        NumEdges += Input != nullptr;
+      for(auto* Usr : N->users())
+        NumEdges += Usr != nullptr;
+    }
+  }
+  double WalkTime = T.elapsed();
+
+  bench::AllocScope ReduceAllocs;
+  T.reset();
+  GraphReducer::RunWithEditor<PeepholeReducer>(G);
+  double ReduceTime = T.elapsed();
+
+  // fixpoint already reached, so this is mostly traversal
+  // and trimming
+  T.reset();
+  GraphReducer::RunWithEditor<PeepholeReducer>(G);
+  double RerunTime = T.elapsed();
+
+  double SeparateTime, CompositeTime;
+  size_t NumSeparateNodes, NumCompositeNodes;
+  {
+    Graph G2;
+    bench::BuildSyntheticModule(G2, NumFuncs, NumStmts);
+    T.reset();
+    GraphReducer::RunWithEditor<PeepholeReducer>(G2);
+    GraphReducer::RunWithEditor<CSEReducer>(G2);
+    SeparateTime = T.elapsed();
+    NumSeparateNodes = G2.node_size();
+  }
+  {
+    Graph G2;
+    bench::BuildSyntheticModule(G2, NumFuncs, NumStmts);
+    T.reset();
+    GraphReducer::RunAll<PeepholeReducer, CSEReducer>(G2);
+    CompositeTime = T.elapsed();
+    NumCompositeNodes = G2.node_size();
+  }
+
+  std::cout << "nodes:                   " << NumNodes << "\n"
+            << "edge walk (x10):         " << WalkTime << " ms"
+            << " (" << NumEdges << " edges)\n"
+            << "peephole run:            " << ReduceTime << " ms\n"
+            << "peephole heap allocs:    " << ReduceAllocs.allocs() << "\n"
+            << "nodes after reduction:   " << G.node_size() << "\n"
+            << "peephole rerun:          " << RerunTime << " ms\n"
+            << "peephole, cse (2 runs):  " << SeparateTime << " ms"
+            << " (" << NumSeparateNodes << " nodes left)\n"
+            << "peephole + cse (1 run):  " << CompositeTime << " ms"
+            << " (" << NumCompositeNodes << " nodes left)\n";
+  return 0;
+}
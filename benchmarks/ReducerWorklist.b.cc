@@ -0,0 +1,123 @@
+/// Measure GraphReducer worklist orders: the number of Reduce
+/// calls needed to reach the fixpoint, and the run time, of
+/// value promotion and peephole folding on parsed source code,
+/// and of peephole folding on one huge synthetic function.
+#include "BenchUtils.h"
+#include "graphir/Frontend/Parser.h"
+#include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/Reductions/Peephole.h"
+#include "graphir/Graph/Reductions/ValuePromotion.h"
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+
+using namespace graphir;
+
+namespace {
+// count the number of Reduce calls
+template<class ReducerT>
+struct CountedReducer : public ReducerT {
+  CountedReducer(GraphEditor::Interface* Editor, size_t* Counter)
+    : ReducerT(Editor), NumReduce(Counter) {}
+
+  GraphReduction Reduce(Node* N) {
+    ++*NumReduce;
+    return ReducerT::Reduce(N);
+  }
+
+  static constexpr
+  const char* name() { return ReducerT::name(); }
+
+private:
+  size_t* NumReduce;
+};
+
+// loops and branches over a handful of variables, so
+// value promotion creates lots of Phis to revisit
+void GenerateSource(std::ostream& OS, unsigned NumFuncs,
+                    unsigned NumStmts) {
+  OS << "main\n";
+  for(auto i = 0U; i < NumFuncs; ++i) {
+    OS << "function f" << i << "(a);\n"
+       << "var x, y, z, n;\n"
+       << "{\n"
+       << "  let x <- a;\n"
+       << "  let y <- 1;\n"
+       << "  let z <- 2;\n"
+       << "  let n <- 0;\n"
+       << "  while n < a do\n";
+    for(auto j = 0U; j < NumStmts; ++j) {
+      OS << "    let x <- x + " << j % 5 << " * 2;\n"
+         << "    if x > y then let y <- y + z * 3 "
+         << "else let z <- z - 4 + " << j % 3 << " fi;\n";
+    }
+    OS << "    let n <- n + 1\n"
+       << "  od;\n"
+       << "  return x + y + z\n"
+       << "};\n";
+  }
+  OS << "{ call OutputNum(call f0(1)) }.\n";
+}
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 20U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 200U;
+  unsigned NumHugeStmts = argc > 3? std::atoi(argv[3]) : 200000U;
+
+  std::stringstream SS;
+  GenerateSource(SS, NumFuncs, NumStmts);
+  auto Source = SS.str();
+
+  using Order = GraphReducer::WorklistOrder;
+  struct {
+    const char* Name;
+    Order O;
+  } Configs[] = {
+    {"LIFO", Order::LIFO},
+    {"RPO", Order::RPO}
+  };
+  for(const auto& C : Configs) {
+    size_t NumPromoteReduce = 0U, NumPeepholeReduce = 0U,
+           NumHugeReduce = 0U, NumNodes, NumHugeNodes;
+    double PromoteTime, PeepholeTime, HugeTime;
+    {
+      std::stringstream Src(Source);
+      Graph G;
+      Parser P(Src, G);
+      if(!P.Parse()) {
+        std::cerr << "Failed to parse the generated source\n";
+        return 1;
+      }
+      NumNodes = G.node_size();
+      bench::Timer T;
+      GraphReducer::RunWithEditor<CountedReducer<ValuePromotion>>(
+        G, C.O, &NumPromoteReduce);
+      PromoteTime = T.elapsed();
+      T.reset();
+      GraphReducer::RunWithEditor<CountedReducer<PeepholeReducer>>(
+        G, C.O, &NumPeepholeReduce);
+      PeepholeTime = T.elapsed();
+    }
+    {
+      Graph G;
+      (void) bench::BuildSyntheticFunction(G, "huge", NumHugeStmts);
+      NumHugeNodes = G.node_size();
+      bench::Timer T;
+      GraphReducer::RunWithEditor<CountedReducer<PeepholeReducer>>(
+        G, C.O, &NumHugeReduce);
+      HugeTime = T.elapsed();
+    }
+
+    std::cout << C.Name << " worklist\n"
+              << "  parsed nodes:            " << NumNodes << "\n"
+              << "  value promotion:         " << NumPromoteReduce
+              << " reductions, " << PromoteTime << " ms\n"
+              << "  peephole:                " << NumPeepholeReduce
+              << " reductions, " << PeepholeTime << " ms\n"
+              << "  huge function nodes:     " << NumHugeNodes << "\n"
+              << "  huge function peephole:  " << NumHugeReduce
+              << " reductions, " << HugeTime << " ms\n";
+  }
+  return 0;
+}
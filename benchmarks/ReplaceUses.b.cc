@@ -0,0 +1,84 @@
+/// Measure replacing all uses of nodes: raw Node::ReplaceWith on
+/// nodes with lots of users of every kind, and Peephole folding
+/// storms where every folded node has a wide fan-out of users that
+/// become foldable in turn.
+#include "BenchUtils.h"
+#include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/Reductions/Peephole.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace graphir;
+
+namespace {
+// A chain of foldable sums, each of them is multiplied by
+// FanOut different constants and accumulated onto the argument
+void BuildFoldingStorm(Graph& G, const std::string& Name,
+                       unsigned ChainLength, unsigned FanOut) {
+  auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName(Name)
+               .AddParameter(Arg)
+               .Build();
+  Node* Acc = Arg;
+  Node* K = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  for(auto i = 0U; i < ChainLength; ++i) {
+    auto* C = NodeBuilder<IrOpcode::ConstantInt>(&G, i % 64).Build();
+    K = NodeBuilder<IrOpcode::BinAdd>(&G).LHS(K).RHS(C).Build();
+    for(auto j = 0U; j < FanOut; ++j) {
+      auto* CJ = NodeBuilder<IrOpcode::ConstantInt>(&G, j % 64 + 1).Build();
+      auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+                   .LHS(K).RHS(CJ).Build();
+      Acc = NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Acc).RHS(Prod).Build();
+    }
+  }
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Acc).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+}
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 20U;
+  unsigned ChainLength = argc > 2? std::atoi(argv[2]) : 200U;
+  unsigned FanOut = argc > 3? std::atoi(argv[3]) : 50U;
+
+  double ReplaceTime, StormTime;
+  size_t NumReplacedUses = 0U, NumNodes;
+  {
+    // bounce the users of every kind between two nodes
+    Graph G;
+    auto* A = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+    auto* B = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+    for(auto i = 0U; i < 10000U; ++i) {
+      auto* Usr = new (&G) Node(IrOpcode::BinAdd, {A, A}, {A}, {A});
+      G.InsertNode(Usr);
+    }
+    bench::Timer T;
+    for(auto i = 0U; i < 100U; ++i) {
+      NumReplacedUses += A->user_size();
+      A->ReplaceWith(B);
+      std::swap(A, B);
+    }
+    ReplaceTime = T.elapsed();
+  }
+  {
+    Graph G;
+    for(auto i = 0U; i < NumFuncs; ++i)
+      BuildFoldingStorm(G, "func" + std::to_string(i), ChainLength, FanOut);
+    NumNodes = G.node_size();
+    bench::Timer T;
+    GraphReducer::RunWithEditor<PeepholeReducer>(G);
+    StormTime = T.elapsed();
+  }
+
+  std::cout << "uses replaced:           " << NumReplacedUses << "\n"
+            << "ReplaceWith time:        " << ReplaceTime << " ms\n"
+            << "folding storm nodes:     " << NumNodes << "\n"
+            << "peephole storm time:     " << StormTime << " ms\n";
+  return 0;
+}
@@ -0,0 +1,47 @@
+/// Measure building a large module with and without value
+/// numbering in the builders, and the CSE run that follows.
+#include "BenchUtils.h"
+#include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/Reductions/CSE.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace graphir;
+
+namespace {
+struct Result {
+  size_t NumNodes;
+  double BuildTime, CSETime;
+};
+
+Result Measure(bool ValueNumbering, unsigned NumFuncs, unsigned NumStmts) {
+  Result R;
+  Graph G;
+  G.SetValueNumbering(ValueNumbering);
+  bench::Timer T;
+  bench::BuildSyntheticModule(G, NumFuncs, NumStmts);
+  R.BuildTime = T.elapsed();
+  R.NumNodes = G.node_size();
+
+  T.reset();
+  GraphReducer::RunWithEditor<CSEReducer>(G);
+  R.CSETime = T.elapsed();
+  return R;
+}
+} // end anonymous namespace
+
+int main(int argc, char** argv) {
+  unsigned NumFuncs = argc > 1? std::atoi(argv[1]) : 20U;
+  unsigned NumStmts = argc > 2? std::atoi(argv[2]) : 500U;
+
+  auto Plain = Measure(false, NumFuncs, NumStmts);
+  auto GVN = Measure(true, NumFuncs, NumStmts);
+
+  std::cout << "nodes built:             " << Plain.NumNodes
+            << " -> " << GVN.NumNodes << "\n"
+            << "build time:              " << Plain.BuildTime
+            << " ms -> " << GVN.BuildTime << " ms\n"
+            << "CSE run:                 " << Plain.CSETime
+            << " ms -> " << GVN.CSETime << " ms\n";
+  return 0;
+}
@@ -132,6 +132,16 @@ num_edges(const graphir::GraphSchedule& g) {
 
 /// Property Map Concept
 namespace graphir {
+inline size_t dense_vertex_id(const BasicBlock* BB) {
+  return BB->getId().get<size_t>();
+}
+inline size_t dense_vertex_id_bound(const GraphSchedule& g) {
+  return g.block_size();
+}
+
+// color map for DFS and BFS on GraphSchedule
+using BlockColorMap = DenseVertexMap<BasicBlock, boost::default_color_type>;
+
 template<>
 struct graph_id_map<GraphSchedule, boost::vertex_index_t> {
   using value_type = size_t;
@@ -139,27 +149,24 @@ struct graph_id_map<GraphSchedule, boost::vertex_index_t> {
   using key_type = BasicBlock*;
   struct category : public boost::readable_property_map_tag {};
 
-  graph_id_map(const GraphSchedule& g) : G(g) {}
+  graph_id_map(const GraphSchedule&) {}
 
+  // block ids are their positions in the schedule
   reference operator[](const key_type& key) const {
-    // just use linear search for now
-    // TODO: improve time complexity
-    value_type Idx = 0;
-    for(auto I = G.block_cbegin(), E = G.block_cend();
-        I != E; ++I, ++Idx) {
-      if(I->get() == key) break;
-    }
-    return Idx;
+    return dense_vertex_id(key);
   }
-
-private:
-  const GraphSchedule &G;
 };
 using GraphScheduleVertexIdMap
   = graph_id_map<GraphSchedule, boost::vertex_index_t>;
 } // end namespace graphir
 
 namespace boost {
+template<>
+struct property_map<graphir::GraphSchedule, boost::vertex_index_t> {
+  using type = graphir::GraphScheduleVertexIdMap;
+  using const_type = type;
+};
+
 // get() for vertex id property map
 inline typename graphir::GraphScheduleVertexIdMap::reference
 get(const graphir::GraphScheduleVertexIdMap &pmap,
@@ -168,7 +175,7 @@ get(const graphir::GraphScheduleVertexIdMap &pmap,
 }
 // get() for getting vertex id property map from graph
 inline graphir::GraphScheduleVertexIdMap
-get(boost::vertex_index_t tag, const graphir::GraphSchedule& g) {
+get(boost::vertex_index_t, const graphir::GraphSchedule& g) {
   return graphir::GraphScheduleVertexIdMap(g);
 }
 } // end namespace boost
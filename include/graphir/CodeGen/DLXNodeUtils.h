@@ -144,10 +144,16 @@ struct NodeBuilder<IrOpcode::VirtDLXBinOps> {
 
   Node* Build() {
     assert(LHSVal && RHSVal);
-    auto* N = new Node(OC, {LHSVal, RHSVal});
-    LHSVal->Users.push_back(N);
-    RHSVal->Users.push_back(N);
+    bool Pure = IsArithmetic(OC) && G->IsValueNumbering();
+    if(Pure) {
+      if(auto* N = G->FindValueNumber(OC, LHSVal, RHSVal,
+                                      IsCommutative(OC)))
+        return N;
+    }
+    auto* N = new (G) Node(OC, {LHSVal, RHSVal});
     G->InsertNode(N);
+    if(Pure)
+      G->RecordValueNumber(N, IsCommutative(OC));
     return N;
   }
 
@@ -155,6 +161,30 @@ private:
   Graph* G;
   IrOpcode::ID OC;
   bool IsImmediate;
+
+  static bool IsArithmetic(IrOpcode::ID OC) {
+    switch(OC) {
+#define DLX_ARITH_OP(OC)  \
+    case IrOpcode::DLX##OC: \
+    case IrOpcode::DLX##OC##I:
+#include "graphir/Graph/DLXOpcodes.def"
+      return true;
+    default:
+      return false;
+    }
+  }
+  static bool IsCommutative(IrOpcode::ID OC) {
+    switch(OC) {
+    case IrOpcode::DLXAdd:
+    case IrOpcode::DLXMul:
+    case IrOpcode::DLXBitOR:
+    case IrOpcode::DLXBitAND:
+    case IrOpcode::DLXBitXOR:
+      return true;
+    default:
+      return false;
+    }
+  }
   Node *LHSVal, *RHSVal;
 };
 
@@ -167,10 +197,8 @@ struct NodeBuilder<IrOpcode::DLXLdW>
   Node* Build() {
     assert(OffsetNode->getOp() == IrOpcode::ConstantInt &&
            "Offset not constant?");
-    auto* N = new Node(IrOpcode::DLXLdW,
+    auto* N = new (G) Node(IrOpcode::DLXLdW,
                        {BaseAddrNode, OffsetNode});
-    BaseAddrNode->Users.push_back(N);
-    OffsetNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -182,10 +210,8 @@ struct NodeBuilder<IrOpcode::DLXLdX>
     : _internal::MemNodeBuilder<IrOpcode::DLXLdX>(graph) {}
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::DLXLdX,
+    auto* N = new (G) Node(IrOpcode::DLXLdX,
                        {BaseAddrNode, OffsetNode});
-    BaseAddrNode->Users.push_back(N);
-    OffsetNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -205,12 +231,9 @@ struct NodeBuilder<IrOpcode::DLXStW>
   Node* Build() {
     assert(OffsetNode->getOp() == IrOpcode::ConstantInt &&
            "Offset not constant?");
-    auto* N = new Node(IrOpcode::DLXStW,
+    auto* N = new (G) Node(IrOpcode::DLXStW,
                        {BaseAddrNode, OffsetNode,
                         SrcNode});
-    BaseAddrNode->Users.push_back(N);
-    OffsetNode->Users.push_back(N);
-    SrcNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -230,12 +253,9 @@ struct NodeBuilder<IrOpcode::DLXStX>
   }
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::DLXStX,
+    auto* N = new (G) Node(IrOpcode::DLXStX,
                        {BaseAddrNode, OffsetNode,
                         SrcNode});
-    BaseAddrNode->Users.push_back(N);
-    OffsetNode->Users.push_back(N);
-    SrcNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -259,10 +279,8 @@ struct NodeBuilder<IrOpcode::VirtDLXTriOps> {
   }
 
   Node* Build() {
-    auto* N = new Node(OC,
+    auto* N = new (G) Node(OC,
                        {Vals[0], Vals[1], Vals[2]});
-    for(auto* V: Vals)
-      V->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -281,10 +299,9 @@ struct NodeBuilder<IrOpcode::VirtDLXCallsiteEnd> {
 
   Node* Build() {
     assert(CallsiteBegin);
-    auto* N = new Node(IrOpcode::VirtDLXCallsiteEnd,
+    auto* N = new (G) Node(IrOpcode::VirtDLXCallsiteEnd,
                        {}, {},
                        {CallsiteBegin});
-    CallsiteBegin->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -307,11 +324,9 @@ struct NodeBuilder<IrOpcode::VirtDLXPassParam> {
 
   Node* Build() {
     assert(ParamVal && CallsiteBegin);
-    auto* N = new Node(IrOpcode::VirtDLXPassParam,
+    auto* N = new (G) Node(IrOpcode::VirtDLXPassParam,
                        {ParamVal}, {},
                        {CallsiteBegin});
-    ParamVal->Users.push_back(N);
-    CallsiteBegin->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -330,9 +345,8 @@ struct NodeBuilder<IrOpcode::DLXRet> {
 
   Node* Build() {
     assert(LinkReg);
-    auto* N = new Node(IrOpcode::DLXRet,
+    auto* N = new (G) Node(IrOpcode::DLXRet,
                        {LinkReg});
-    LinkReg->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -4,6 +4,7 @@
 #include "boost/iterator/transform_iterator.hpp"
 #include "graphir/CodeGen/BasicBlock.h"
 #include "graphir/Graph/Graph.h"
+#include "graphir/Graph/NodeMap.h"
 #include "graphir/Graph/NodeMarker.h"
 #include "graphir/Support/iterator_range.h"
 #include "graphir/Support/STLExtras.h"
@@ -21,7 +22,7 @@ class GraphSchedule {
   // owner of basic blocks
   // must be in RPO order
   std::vector<std::unique_ptr<BasicBlock>> Blocks;
-  std::unordered_map<Node*, BasicBlock*> Node2Block;
+  NodeMap<BasicBlock*> Node2Block;
   std::vector<Node*> RPONodes;
 
   struct RPONodesVisitor;
@@ -277,7 +278,7 @@ public:
 
   Node* MapBlockOffset(BasicBlock* BB) {
     if(!BlockOffsets.find_node(BB)) {
-      auto* N = new Node(IrOpcode::DLXOffset, {});
+      auto* N = new (&G) Node(IrOpcode::DLXOffset, {});
       G.InsertNode(N);
       BlockOffsets.insert({N, BB});
     }
@@ -17,6 +17,12 @@ public:
   static constexpr
   const char* name() { return "pre-machine-lowering"; }
 
+  static constexpr
+  IrOpcode::OpcodeSet opcodes() {
+    return {IrOpcode::BinAdd, IrOpcode::BinSub, IrOpcode::BinMul,
+            IrOpcode::BinDiv, IrOpcode::MemLoad, IrOpcode::MemStore};
+  }
+
   GraphReduction Reduce(Node* N);
 };
 } // end namespace graphir
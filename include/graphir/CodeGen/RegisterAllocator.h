@@ -2,10 +2,9 @@
 #define GRAPHIR_CODEGEN_REGISTERALLOCATOR_H
 #include "graphir/CodeGen/DLXNodeUtils.h"
 #include "graphir/CodeGen/GraphScheduling.h"
+#include "graphir/Graph/NodeMap.h"
 #include <array>
 #include <bitset>
-#include <unordered_map>
-#include <map>
 #include <vector>
 
 namespace graphir {
@@ -71,7 +70,7 @@ class LinearScanRegisterAllocator : public RegisterAllocator {
   const std::array<Node*, NumRegister + 1> RegNodes;
 
   // RPO ordered users
-  std::unordered_map<Node*, std::vector<Node*>> OrderedUsers;
+  NodeMap<std::vector<Node*>> OrderedUsers;
   // lazily compute
   std::vector<Node*>& getOrderedUsers(Node* N);
   Node* LiveRangeEnd(Node* N) {
@@ -90,7 +89,7 @@ class LinearScanRegisterAllocator : public RegisterAllocator {
   std::vector<Node*> SpillParams;
 
   // VirtDLXCallsiteBegin node -> active registers at this moment
-  std::unordered_map<Node*, std::bitset<NumRegister>> CallerSaved;
+  NodeMap<std::bitset<NumRegister>> CallerSaved;
   // Callee-saved registers that have ever clobbered in this function
   std::bitset<NumRegister> CalleeSaved;
 
@@ -103,7 +102,7 @@ class LinearScanRegisterAllocator : public RegisterAllocator {
   }
 
   // value node -> register number or stack slot
-  std::map<Node*, Location> Assignment;
+  NodeMap<Location> Assignment;
 
   Node* CreateMove(Node* From);
 
@@ -1,6 +1,7 @@
 #ifndef GRAPHIR_GRAPH_ATTRIBUTE_H
 #define GRAPHIR_GRAPH_ATTRIBUTE_H
 #include "graphir/Graph/Node.h"
+#include <type_traits>
 
 namespace graphir {
 enum class Attr {
@@ -8,9 +9,22 @@ enum class Attr {
   ReadMem,
   WriteMem,
   HasSideEffect, // enviornment side-effects
-  IsBuiltin
+  IsBuiltin,
+  LAST_ATTR = IsBuiltin
 };
 
+template<Attr AT>
+constexpr Node::AttrMaskTy AttrBit
+  = Node::AttrMaskTy(1U) << static_cast<unsigned>(AT);
+static_assert(static_cast<unsigned>(Attr::LAST_ATTR) <
+              sizeof(Node::AttrMaskTy) * 8U,
+              "Node::AttrMask is too narrow");
+
+// attributes without payload don't need any storage
+// other than their bit in Node::AttrMask
+template<Attr AT>
+struct attr_has_payload : std::true_type {};
+
 // Forward declaration
 template<Attr AT>
 class Attribute;
@@ -44,28 +58,34 @@ class Attribute : public AttributeConcept {
   template<>  \
   class Attribute<Attr::AT> : public AttributeConcept
 
-ATTRIBUTE_IMPL(NoMem) {
+#define FLAG_ATTRIBUTE_IMPL(AT) \
+  template<>  \
+  struct attr_has_payload<Attr::AT> : std::false_type {}; \
+  ATTRIBUTE_IMPL(AT)
+
+FLAG_ATTRIBUTE_IMPL(NoMem) {
   Attr Kind() const override { return Attr::NoMem; }
 };
 
 // Both Read/WriteMem implies some really coarse grain
 // global memory access mode. It won't tell which
 // global memory does it access.
-ATTRIBUTE_IMPL(ReadMem) {
+FLAG_ATTRIBUTE_IMPL(ReadMem) {
   Attr Kind() const override { return Attr::ReadMem; }
 };
-ATTRIBUTE_IMPL(WriteMem) {
+FLAG_ATTRIBUTE_IMPL(WriteMem) {
   Attr Kind() const override { return Attr::WriteMem; }
 };
 
 // Environment side-effects (e.g. read/write output)
-ATTRIBUTE_IMPL(HasSideEffect) {
+FLAG_ATTRIBUTE_IMPL(HasSideEffect) {
   Attr Kind() const override { return Attr::HasSideEffect; }
 };
 // Is builtin functions
-ATTRIBUTE_IMPL(IsBuiltin) {
+FLAG_ATTRIBUTE_IMPL(IsBuiltin) {
   Attr Kind() const override { return Attr::IsBuiltin; }
 };
+#undef FLAG_ATTRIBUTE_IMPL
 #undef ATTRIBUTE_IMPL
 } // end namespace graphir
 #endif
@@ -4,7 +4,6 @@
 #include <memory>
 #include <utility>
 #include <list>
-#include <set>
 
 namespace graphir {
 // Forward declaration
@@ -16,26 +15,27 @@ struct AttributeBuilder {
 
   template<Attr AT, class... CtorArgs>
   AttributeBuilder& Add(CtorArgs &&... args) {
-    Attrs.emplace_back(
-      new Attribute<AT>(std::forward<CtorArgs>(args)...)
-    );
-    AttrSet.insert(AT);
+    if(attr_has_payload<AT>::value)
+      Attrs.emplace_back(
+        new Attribute<AT>(std::forward<CtorArgs>(args)...)
+      );
+    AttrSet |= AttrBit<AT>;
     return *this;
   }
 
   template<Attr AT>
   bool hasAttr() const {
-    return AttrSet.count(AT);
+    return AttrSet & AttrBit<AT>;
   }
 
   void Attach(Node* N);
 
-  bool empty() const { return Attrs.empty(); }
+  bool empty() const { return !AttrSet; }
 
 private:
   Graph& G;
   std::list<std::unique_ptr<AttributeConcept>> Attrs;
-  std::set<Attr> AttrSet;
+  Node::AttrMaskTy AttrSet = 0U;
 };
 } // end namespace graphir
 #endif
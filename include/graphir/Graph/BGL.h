@@ -27,12 +27,7 @@ struct graph_traits<graphir::Graph> {
   }
 
   /// VertexListGraphConcept
-  using vertex_iterator
-    = boost::transform_iterator<graphir::unique_ptr_unwrapper<graphir::Node>,
-                                typename graphir::Graph::node_iterator,
-                                graphir::Node*, // Refrence type
-                                graphir::Node* // Value type
-                                >;
+  using vertex_iterator = typename graphir::Graph::node_iterator;
   using vertices_size_type = size_t;
 
   /// EdgeListGraphConcept
@@ -41,7 +36,7 @@ struct graph_traits<graphir::Graph> {
 
   /// IncidenceGraphConcept
   using out_edge_iterator
-    = boost::transform_iterator<typename graphir::Use::BuilderFunctor,
+    = boost::transform_iterator<graphir::Use::BuilderFunctor<>,
                                 typename graphir::Node::input_iterator,
                                 graphir::Use, // Reference type
                                 graphir::Use // Value type
@@ -76,7 +71,7 @@ struct graph_traits<graphir::SubGraph> {
 
   /// IncidenceGraphConcept
   using out_edge_iterator
-    = boost::transform_iterator<typename graphir::Use::BuilderFunctor,
+    = boost::transform_iterator<graphir::Use::BuilderFunctor<>,
                                 typename graphir::Node::input_iterator,
                                 graphir::Use, // Reference type
                                 graphir::Use // Value type
@@ -89,6 +84,18 @@ struct graph_traits<graphir::SubGraph> {
     public boost::incidence_graph_tag {};
 };
 
+template<class PatcherT>
+struct graph_traits<graphir::SubGraphView<PatcherT>>
+  : public graph_traits<graphir::SubGraph> {
+  /// IncidenceGraphConcept
+  using out_edge_iterator
+    = boost::transform_iterator<graphir::Use::BuilderFunctor<PatcherT>,
+                                typename graphir::Node::input_iterator,
+                                graphir::Use, // Reference type
+                                graphir::Use // Value type
+                                >;
+};
+
 /// Note: We mark most of the BGL trait functions here as inline
 /// because they're trivial.
 /// FIXME: Will putting them into separated source file helps reducing
@@ -99,13 +106,7 @@ inline
 std::pair<typename boost::graph_traits<graphir::Graph>::vertex_iterator,
           typename boost::graph_traits<graphir::Graph>::vertex_iterator>
 vertices(graphir::Graph& g) {
-  using vertex_it_t
-    = typename boost::graph_traits<graphir::Graph>::vertex_iterator;
-  graphir::unique_ptr_unwrapper<graphir::Node> functor;
-  return std::make_pair(
-    vertex_it_t(g.node_begin(), functor),
-    vertex_it_t(g.node_end(), functor)
-  );
+  return std::make_pair(g.node_begin(), g.node_end());
 }
 inline
 std::pair<typename boost::graph_traits<graphir::Graph>::vertex_iterator,
@@ -193,7 +194,7 @@ num_edges(const graphir::SubGraph& g) {
 template<class GraphT>
 inline graphir::enable_if_t<
   std::is_same<GraphT,graphir::Graph>::value ||
-  std::is_same<GraphT,graphir::SubGraph>::value,
+  std::is_base_of<graphir::SubGraph,GraphT>::value,
   typename boost::graph_traits<GraphT>::vertex_descriptor>
 source(const graphir::Use& e, const GraphT& g) {
   return const_cast<graphir::Node*>(e.Source);
@@ -201,7 +202,7 @@ source(const graphir::Use& e, const GraphT& g) {
 template<class GraphT>
 inline graphir::enable_if_t<
   std::is_same<GraphT,graphir::Graph>::value ||
-  std::is_same<GraphT,graphir::SubGraph>::value,
+  std::is_base_of<graphir::SubGraph,GraphT>::value,
   typename boost::graph_traits<GraphT>::vertex_descriptor>
 target(const graphir::Use& e, const GraphT& g) {
   return const_cast<graphir::Node*>(e.Dest);
@@ -218,8 +219,22 @@ out_edges(graphir::Node* u, const T& g) {
   // for now, we don't care about the kind of edge
   using edge_it_t
     = typename boost::graph_traits<T>::out_edge_iterator;
-  graphir::Use::BuilderFunctor functor(u, graphir::Use::K_NONE,
-                                     g.GetEdgePatcher());
+  graphir::Use::BuilderFunctor<> functor(u);
+  return std::make_pair(
+    edge_it_t(u->inputs().begin(), functor),
+    edge_it_t(u->inputs().end(), functor)
+  );
+}
+template<class PatcherT>
+inline
+std::pair<
+  typename boost::graph_traits<graphir::SubGraphView<PatcherT>>::out_edge_iterator,
+  typename boost::graph_traits<graphir::SubGraphView<PatcherT>>::out_edge_iterator>
+out_edges(graphir::Node* u, const graphir::SubGraphView<PatcherT>& g) {
+  using edge_it_t = typename boost::graph_traits<
+                      graphir::SubGraphView<PatcherT>>::out_edge_iterator;
+  graphir::Use::BuilderFunctor<PatcherT> functor(u, graphir::Use::K_NONE,
+                                                 g.getEdgePatcher());
   return std::make_pair(
     edge_it_t(u->inputs().begin(), functor),
     edge_it_t(u->inputs().end(), functor)
@@ -229,7 +244,7 @@ out_edges(graphir::Node* u, const T& g) {
 template<class T>
 inline graphir::enable_if_t<
   std::is_same<T, graphir::Graph>::value ||
-  std::is_same<T, graphir::SubGraph>::value,
+  std::is_base_of<graphir::SubGraph, T>::value,
   typename boost::graph_traits<T>::degree_size_type>
 out_degree(graphir::Node* u, const T& g) {
   return u->getNumValueInput()
@@ -240,6 +255,15 @@ out_degree(graphir::Node* u, const T& g) {
 
 /// Property Map Concept
 namespace graphir {
+// upper bound (exclusive) of the ids passed to DenseVertexMap
+inline size_t dense_vertex_id_bound(const Graph& g) {
+  return g.getNumNodeIds();
+}
+inline size_t dense_vertex_id_bound(const SubGraph& g) {
+  auto* Tail = g.getTailNode();
+  return Tail? dense_vertex_id_bound(*Tail->getGraph()) : 0U;
+}
+
 template<class GraphT>
 struct graph_id_map<GraphT, boost::vertex_index_t> {
   using value_type = size_t;
@@ -247,25 +271,40 @@ struct graph_id_map<GraphT, boost::vertex_index_t> {
   using key_type = Node*;
   struct category : public boost::readable_property_map_tag {};
 
-  graph_id_map(const GraphT& g) : G(g) {}
+  // index is the position in the node list, which is
+  // collected upfront so every lookup is O(1)
+  graph_id_map(const GraphT& g) : Indices(g) {
+    value_type Idx = 0;
+    for(auto I = g.node_cbegin(), E = g.node_cend(); I != E; ++I)
+      Indices[const_cast<Node*>(GraphT::GetNodeFromIt(I))] = Idx++;
+  }
 
   reference operator[](const key_type& key) const {
-    // just use linear search for now
-    // TODO: improve time complexity
-    value_type Idx = 0;
-    for(auto I = G.node_cbegin(), E = G.node_cend();
-        I != E; ++I, ++Idx) {
-      if(GraphT::GetNodeFromIt(I) == key) break;
-    }
-    return Idx;
+    return Indices[key];
   }
 
 private:
-  const GraphT &G;
+  DenseVertexMap<Node, value_type> Indices;
 };
 } // end namespace graphir
 
 namespace boost {
+// so that BGL algorithms pick up the vertex_index map by default
+template<>
+struct property_map<graphir::Graph, boost::vertex_index_t> {
+  using type = graphir::graph_id_map<graphir::Graph, boost::vertex_index_t>;
+  using const_type = type;
+};
+template<>
+struct property_map<graphir::SubGraph, boost::vertex_index_t> {
+  using type
+    = graphir::graph_id_map<graphir::SubGraph, boost::vertex_index_t>;
+  using const_type = type;
+};
+template<class PatcherT>
+struct property_map<graphir::SubGraphView<PatcherT>, boost::vertex_index_t>
+  : public property_map<graphir::SubGraph, boost::vertex_index_t> {};
+
 // get() for vertex id property map
 template<class GraphT>
 inline graphir::enable_if_t<
@@ -283,11 +322,48 @@ inline graphir::enable_if_t<
   std::is_same<GraphT,graphir::Graph>::value ||
   std::is_same<GraphT,graphir::SubGraph>::value,
   typename graphir::graph_id_map<GraphT,boost::vertex_index_t>>
-get(boost::vertex_index_t tag, const GraphT& g) {
+get(boost::vertex_index_t, const GraphT& g) {
   return graphir::graph_id_map<GraphT,boost::vertex_index_t>(g);
 }
+template<class PatcherT>
+inline graphir::graph_id_map<graphir::SubGraph,boost::vertex_index_t>
+get(boost::vertex_index_t, const graphir::SubGraphView<PatcherT>& g) {
+  return graphir::graph_id_map<graphir::SubGraph,boost::vertex_index_t>(g);
+}
 } // end namespace boost
 
+namespace graphir {
+// Edge patcher policy for SubGraphView that reverses loop back-edges,
+// i.e. the second input of Loop and the Phis attached to it, so that
+// a DFS from the end node visits nodes in topological order
+struct BackEdgeReversed {
+  Use operator()(const Use& OrigEdge) const {
+    auto* Source = OrigEdge.Source;
+    Node* Backedge = nullptr;
+    NodeProperties<IrOpcode::Phi> PNP(Source);
+    if(PNP && PNP.CtrlPivot()->getOp() == IrOpcode::Loop) {
+      if(Source->getNumValueInput() &&
+         !Source->getNumEffectInput()) {
+        // normal value phi
+        assert(Source->getNumValueInput() >= 2);
+        // backedge is always the second input
+        Backedge = Source->getValueInput(1);
+      } else {
+        // effect phi
+        assert(Source->getNumEffectInput() >= 2);
+        Backedge = Source->getEffectInput(1);
+      }
+    } else if(Source->getOp() == IrOpcode::Loop) {
+      assert(Source->getNumControlInput() >= 2);
+      Backedge = Source->getControlInput(1);
+    }
+    if(Backedge && Backedge == OrigEdge.Dest)
+      return Use(OrigEdge.Dest, OrigEdge.Source, OrigEdge.DepKind);
+    return OrigEdge;
+  }
+};
+} // end namespace graphir
+
 /// PropertyWriter Concept
 namespace graphir {
 struct graph_prop_writer {
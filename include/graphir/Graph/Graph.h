@@ -1,12 +1,18 @@
 #ifndef GRAPHIR_GRAPH_GRAPH_H
 #define GRAPHIR_GRAPH_GRAPH_H
+#include "graphir/Support/Allocator.h"
 #include "graphir/Support/iterator_range.h"
 #include "graphir/Support/Graph.h"
 #include "graphir/Graph/Node.h"
 #include "graphir/Graph/Attribute.h"
+#include "graphir/Graph/NodeMap.h"
+#include "boost/iterator/filter_iterator.hpp"
+#include <array>
+#include <deque>
 #include <memory>
+#include <string>
+#include <string_view>
 #include <iostream>
-#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -15,52 +21,75 @@ namespace graphir {
 class SubGraph {
   template<class T>
   friend struct std::hash;
+  friend class Graph;
 
-  // only hold the tail node, lazily travel the graph when needed
+  // only hold the tail node, the reachable nodes are
+  // collected and cached by the owner Graph
   Node* TailNode;
 
-  typename Use::BuilderFunctor::PatcherTy EdgePatcher;
+  using NodeListRef = std::shared_ptr<const std::vector<Node*>>;
+  NodeListRef getNodeList() const;
+  // return list of nodes grouped by opcode, and the range
+  // of nodes with opcode OC in it
+  NodeListRef getNodeListOf(IrOpcode::ID OC,
+                            size_t& Begin, size_t& End) const;
 
 public:
-  SubGraph() : TailNode(nullptr), EdgePatcher(nullptr) {}
+  SubGraph() : TailNode(nullptr) {}
 
   explicit SubGraph(Node* Tail) : TailNode(Tail) {}
 
+  Node* getTailNode() const { return TailNode; }
+
   bool operator==(const SubGraph& Other) const {
     return TailNode == Other.TailNode;
   }
 
-  void SetEdgePatcher(Use::BuilderFunctor::PatcherTy Patcher) {
-    EdgePatcher = Patcher;
-  }
-  void ClearEdgePatcher() { EdgePatcher = nullptr; }
-  const Use::BuilderFunctor::PatcherTy& GetEdgePatcher() const {
-    return EdgePatcher;
-  }
-
-  using node_iterator = lazy_node_iterator<SubGraph, false>;
-  using const_node_iterator = lazy_node_iterator<SubGraph, true>;
+  // nodes in BFS order starting from the tail node
+  using node_iterator = snapshot_node_iterator<false>;
+  using const_node_iterator = snapshot_node_iterator<true>;
   static Node* GetNodeFromIt(const node_iterator& NodeIt) { return *NodeIt; }
   static const Node* GetNodeFromIt(const const_node_iterator& NodeIt) {
     return *NodeIt;
   }
-  node_iterator node_begin() { return node_iterator(TailNode); }
+  node_iterator node_begin() { return node_iterator(getNodeList()); }
   node_iterator node_end() { return node_iterator(); }
   llvm::iterator_range<node_iterator> nodes() {
     return llvm::make_range(node_begin(), node_end());
   }
   const_node_iterator node_cbegin() const {
-    return const_node_iterator(const_cast<const Node*>(TailNode));
+    return const_node_iterator(getNodeList());
   }
   const_node_iterator node_cend() const { return const_node_iterator(); }
   size_t node_size() const;
 
+  // nodes with opcode OC, in BFS order
+  llvm::iterator_range<node_iterator> nodes_of(IrOpcode::ID OC) {
+    size_t Begin, End;
+    auto List = getNodeListOf(OC, Begin, End);
+    return llvm::make_range(node_iterator(List, Begin, End), node_end());
+  }
+
   using edge_iterator = lazy_edge_iterator<SubGraph>;
   edge_iterator edge_begin();
   edge_iterator edge_end();
   size_t edge_size();
   size_t edge_size() const { return const_cast<SubGraph*>(this)->edge_size(); }
 };
+
+// SubGraph whose out-edges are rewritten by PatcherT when
+// traversed with BGL algorithms, e.g. SubGraphView<BackEdgeReversed>
+template<class PatcherT>
+class SubGraphView : public SubGraph {
+  PatcherT Patcher;
+
+public:
+  explicit SubGraphView(const SubGraph& SG,
+                        const PatcherT& P = PatcherT())
+    : SubGraph(SG), Patcher(P) {}
+
+  const PatcherT& getEdgePatcher() const { return Patcher; }
+};
 } // end namespace graphir
 
 namespace std {
@@ -88,11 +117,25 @@ class Graph {
   friend struct NodeProperties;
   friend class NodeMarkerBase;
   friend struct AttributeBuilder;
+  friend class Node;
+  friend class SubGraph;
 
-  std::vector<std::unique_ptr<Node>> Nodes;
+  // Storage of all the nodes. Slots of removed nodes
+  // are not reused, they're reclaimed along with the Graph
+  BumpPtrAllocator NodeAllocator;
+  std::vector<Node*> Nodes;
+  // next dense node id, ids are never reused
+  Node::IdTy NodeIdCounter;
+  // map from node id to node, null for removed nodes.
+  // Edges are resolved through it in compact edge mode
+  std::vector<Node*> NodeTable;
 
-  // Constant pools
-  NodeBiMap<std::string> ConstStrPool;
+  // Constant pools, only used for interning. The values
+  // themselves are stored in the constant nodes.
+  // Strings are owned by ConstStrStorage, whose element
+  // addresses are stable
+  std::deque<std::string> ConstStrStorage;
+  NodeBiMap<std::string_view> ConstStrPool;
   NodeBiMap<int32_t> ConstNumberPool;
   Node* DeadNode;
 
@@ -104,14 +147,162 @@ class Graph {
 
   // attribute storage (owner of attribute implements)
   // Node where attribute attached -> list of Attribute implement
+  // Only attributes carrying data are stored here, the presence
+  // of every attribute is recorded in Node::AttrMask
   using AttributeList = std::list<std::unique_ptr<AttributeConcept>>;
-  std::unordered_map<Node*, AttributeList> Attributes;
-  std::unordered_set<Node*> GlobalVariables;
+  NodeMap<AttributeList> Attributes;
+  NodeSet GlobalVariables;
 
   // recording state of NodeMarkers
-  typename Node::MarkerTy MarkerMax;
+  using MarkerTy = typename Node::MarkerTy;
+  struct MarkerSlotState {
+    bool Active = false;
+    // epoch of the latest NodeMarker in this slot. Every slot
+    // counts on its own, so a wraparound only sweeps that slot
+    MarkerTy LastEpoch = 0U;
+  };
+  std::array<MarkerSlotState, Node::NumMarkerSlots> MarkerSlots;
+  // return the slot index, or Node::NumMarkerSlots if
+  // all the slots are taken
+  unsigned AcquireMarkerSlot();
+  void ReleaseMarkerSlot(unsigned Slot);
+
+  // bumped whenever an edge is added or removed
+  size_t MutationEpoch;
+
+  // see TrackGarbageCandidates
+  std::vector<Node*>* GarbageCandidates;
+  // MutationEpoch and NodeIdCounter at the last MarkGarbageFree
+  size_t GarbageFreeEpoch, GarbageFreeNumIds;
+  // cleared if a root is removed while nobody is tracking
+  bool GarbageFree;
+  // N is no longer a root of liveness
+  void onRootRemoved(Node* N);
+  // reachable nodes of SubGraphs, keyed by the tail node.
+  // Only valid in the epoch they're collected
+  struct SubGraphNodeCache {
+    size_t Epoch;
+    SubGraph::NodeListRef NodeList;
+    // NodeList stably sorted by opcode, and the start
+    // position of each opcode in it. Built on demand
+    SubGraph::NodeListRef NodeListByOp;
+    std::vector<uint32_t> OpOffsets;
+  };
+  NodeMap<SubGraphNodeCache> SubGraphNodes;
+  // visited marks for graph traversals, indexed by node id.
+  // A node is visited if its stamp equals to the current one
+  std::vector<uint32_t> VisitStamps;
+  uint32_t CurVisitStamp;
+  void startNewVisit();
+  // return false if it has been visited
+  bool markVisited(Node* N) {
+    auto& Stamp = VisitStamps[N->getId()];
+    if(Stamp == CurVisitStamp) return false;
+    Stamp = CurVisitStamp;
+    return true;
+  }
+  SubGraph::NodeListRef getSubGraphNodes(Node* Tail);
+  SubGraph::NodeListRef getSubGraphNodesOf(Node* Tail, IrOpcode::ID OC,
+                                           size_t& Begin, size_t& End);
 
-  typename Use::BuilderFunctor::PatcherTy EdgePatcher;
+  // live (i.e. inserted and not killed) nodes of each opcode,
+  // linked through Node::PrevOfOp and Node::NextOfOp
+  struct OpcodeList {
+    Node* Head = nullptr;
+    Node* Tail = nullptr;
+    size_t Size = 0U;
+  };
+  std::vector<OpcodeList> OpcodeLists;
+  void linkOpcodeList(Node* N);
+  // link after Prev, or at the beginning if Prev is null
+  void linkOpcodeListAfter(Node* N, Node* Prev);
+  void unlinkOpcodeList(Node* N);
+
+  // (opcode, LHS, RHS, function) of pure binary nodes
+  struct ValueNumberKey {
+    IrOpcode::ID Op;
+    Node *LHS, *RHS;
+    // see SetValueNumberingFunction, null if any of the
+    // operands belongs to a single function
+    Node* Func;
+
+    bool operator==(const ValueNumberKey& Other) const {
+      return Op == Other.Op && LHS == Other.LHS && RHS == Other.RHS &&
+             Func == Other.Func;
+    }
+
+    struct hash {
+      size_t operator()(const ValueNumberKey& K) const noexcept {
+        size_t Seed = std::hash<unsigned>{}(K.Op);
+        boost::hash_combine(Seed, K.LHS);
+        boost::hash_combine(Seed, K.RHS);
+        boost::hash_combine(Seed, K.Func);
+        return Seed;
+      }
+    };
+  };
+  bool ValueNumbering;
+  Node* ValueNumberFunc;
+  NodeBiMap<ValueNumberKey, ValueNumberKey::hash> ValueNumbers;
+  // global values are shared by all the functions, any
+  // other node belongs to a single function
+  bool isFunctionLocal(Node* N) const;
+  ValueNumberKey getValueNumberKey(IrOpcode::ID OC, Node* LHS, Node* RHS,
+                                   bool Commutative) const {
+    // operands of commutative nodes are ordered by id
+    if(Commutative && RHS->getId() < LHS->getId())
+      std::swap(LHS, RHS);
+    bool Local = isFunctionLocal(LHS) || isFunctionLocal(RHS);
+    return {OC, LHS, RHS, Local? nullptr : ValueNumberFunc};
+  }
+  // called when a node is killed
+  void onNodeKilled(Node* N);
+
+  // number of removed nodes still in Nodes
+  size_t NumTombstones;
+  // see MaybeCollectDeadNodes
+  bool shouldCollectDeadNodes() const {
+    return NumTombstones && NumTombstones * 4U >= Nodes.size() &&
+           !HasCheckpoint();
+  }
+  // kill the node and unlink it from all of its inputs
+  void unlinkNode(Node* N);
+  void sortNodesRPO();
+  void sortNodesBFS();
+
+  // Undo journal of speculative edits. Each entry records how
+  // to revert a single primitive mutation
+  struct JournalEntry {
+    enum Kind : uint8_t {
+      // input Slot of N was Other
+      SetInput,
+      // input Slot of N was inserted
+      InsertInput,
+      // input Slot of N, which was Other, was erased
+      EraseInput,
+      InsertNode,
+      // N was killed, Other was its predecessor in the opcode list
+      KillNode,
+      MarkDead,
+      AddSubRegion
+    };
+    Kind EntryKind;
+    Use::Kind UseKind;
+    unsigned Slot;
+    Node *N, *Other;
+  };
+  std::vector<JournalEntry> Journal;
+  // start position in Journal of each open checkpoint
+  std::vector<size_t> Checkpoints;
+  bool IsRollingBack;
+  void journal(JournalEntry::Kind EK, Node* N, Node* Other = nullptr,
+               unsigned Slot = 0U, Use::Kind UseKind = Use::K_NONE) {
+    if(!Checkpoints.empty() && !IsRollingBack)
+      Journal.push_back({EK, UseKind, Slot, N, Other});
+  }
+  void undo(const JournalEntry& E);
+  // turn a node inserted after the checkpoint into a tombstone
+  void discardNode(Node* N);
 
   // used to marked node index that is inserted in certain
   // period
@@ -120,19 +311,25 @@ class Graph {
 
 public:
   Graph()
-    : DeadNode(nullptr),
-      MarkerMax(0U),
-      EdgePatcher(nullptr),
+    : NodeIdCounter(0U),
+      DeadNode(nullptr),
+      MutationEpoch(0U),
+      GarbageCandidates(nullptr),
+      GarbageFreeEpoch(0U),
+      GarbageFreeNumIds(0U),
+      GarbageFree(true),
+      CurVisitStamp(0U),
+      ValueNumbering(false),
+      ValueNumberFunc(nullptr),
+      NumTombstones(0U),
+      IsRollingBack(false),
       NodeIdxMarker(nullptr),
       NodeIdxCounter(0U) {}
 
-  void SetEdgePatcher(Use::BuilderFunctor::PatcherTy Patcher) {
-    EdgePatcher = Patcher;
-  }
-  void ClearEdgePatcher() { EdgePatcher = nullptr; }
-  const Use::BuilderFunctor::PatcherTy& GetEdgePatcher() const {
-    return EdgePatcher;
-  }
+  Graph(const Graph&) = delete;
+  Graph& operator=(const Graph&) = delete;
+
+  ~Graph();
 
   void SetNodeIdxMarker(NodeMarker<uint16_t>* Marker) {
     NodeIdxMarker = Marker;
@@ -140,20 +337,89 @@ public:
   }
   void ClearNodeIdxMarker() { NodeIdxMarker = nullptr; }
 
-  using node_iterator = typename decltype(Nodes)::iterator;
-  using const_node_iterator = typename decltype(Nodes)::const_iterator;
+  // tombstones stay in the node list until they're swept,
+  // node iterators skip over them
+  struct IsLiveNode {
+    bool operator()(const Node* N) const { return !N->IsRemoved(); }
+  };
+  using node_iterator
+    = boost::filter_iterator<IsLiveNode, typename decltype(Nodes)::iterator>;
+  using const_node_iterator
+    = boost::filter_iterator<IsLiveNode,
+                             typename decltype(Nodes)::const_iterator>;
   static Node* GetNodeFromIt(const node_iterator& NodeIt) {
-    return NodeIt->get();
+    return *NodeIt;
   }
   static const Node* GetNodeFromIt(const const_node_iterator& NodeIt) {
-    return NodeIt->get();
+    return *NodeIt;
+  }
+  node_iterator node_begin() {
+    return node_iterator(Nodes.begin(), Nodes.end());
+  }
+  const_node_iterator node_cbegin() const {
+    return const_node_iterator(Nodes.cbegin(), Nodes.cend());
+  }
+  node_iterator node_end() {
+    return node_iterator(Nodes.end(), Nodes.end());
+  }
+  const_node_iterator node_cend() const {
+    return const_node_iterator(Nodes.cend(), Nodes.cend());
+  }
+  // position in the node list, which is shifted by tombstones
+  Node* getNode(size_t idx) const {
+    assert(!NumTombstones && "Tombstones are not swept");
+    return Nodes.at(idx);
+  }
+  size_t node_size() const { return Nodes.size() - NumTombstones; }
+  // upper bound (exclusive) of node ids ever assigned
+  size_t getNumNodeIds() const { return NodeIdCounter; }
+  // the most recently inserted node that is not removed,
+  // null if there is none
+  Node* getLastNode() const {
+    for(auto It = Nodes.rbegin(), E = Nodes.rend(); It != E; ++It)
+      if(!(*It)->IsRemoved()) return *It;
+    return nullptr;
+  }
+  // null if the node has been removed, even if its
+  // tombstone is not swept yet
+  Node* getNodeById(Node::IdTy Id) const {
+    assert(Id < NodeTable.size());
+    auto* N = NodeTable[Id];
+    return N && !N->IsRemoved()? N : nullptr;
+  }
+
+  const BumpPtrAllocator& getNodeAllocator() const { return NodeAllocator; }
+
+  // Iterate through live nodes with a specific opcode, in the
+  // order they're inserted. Killing or removing the node an
+  // iterator currently points to is fine, but not its successors
+  class op_node_iterator
+    : public boost::iterator_facade<op_node_iterator,
+                                    Node*, // Value type
+                                    boost::forward_traversal_tag,
+                                    Node* // Reference type
+                                    > {
+    friend class boost::iterator_core_access;
+    Node* Cur;
+
+    bool equal(const op_node_iterator& Other) const {
+      return Cur == Other.Cur;
+    }
+    Node* dereference() const { return Cur; }
+    void increment() { Cur = Cur->NextOfOp; }
+
+  public:
+    explicit op_node_iterator(Node* N = nullptr) : Cur(N) {}
+  };
+  llvm::iterator_range<op_node_iterator> nodes_of(IrOpcode::ID OC) const {
+    Node* Head = OC < OpcodeLists.size()? OpcodeLists[OC].Head : nullptr;
+    return llvm::make_range(op_node_iterator(Head), op_node_iterator());
+  }
+  size_t node_size_of(IrOpcode::ID OC) const {
+    return OC < OpcodeLists.size()? OpcodeLists[OC].Size : 0U;
   }
-  node_iterator node_begin() { return Nodes.begin(); }
-  const_node_iterator node_cbegin() const { return Nodes.cbegin(); }
-  node_iterator node_end() { return Nodes.end(); }
-  const_node_iterator node_cend() const { return Nodes.cend(); }
-  Node* getNode(size_t idx) const { return Nodes.at(idx).get(); }
-  size_t node_size() const { return Nodes.size(); }
+
+  size_t getMutationEpoch() const { return MutationEpoch; }
 
   using edge_iterator = lazy_edge_iterator<Graph>;
   edge_iterator edge_begin();
@@ -167,8 +433,69 @@ public:
   }
 
   void InsertNode(Node* N);
+  // Return the iterator to the next node. The node becomes a
+  // tombstone like MarkNodeDead does, and tombstones are swept
+  // lazily, so other node_iterators might be invalidated
   node_iterator RemoveNode(node_iterator It);
 
+  // MarkNodeDead unlinks the node right away but leaves a
+  // tombstone in the node list, then CollectDeadNodes sweeps
+  // all the tombstones in a single pass.
+  // Note that node_iterators are invalidated by CollectDeadNodes
+  enum class NodeOrder : uint8_t {
+    Unchanged,
+    // per function, definitions before their users. Nodes
+    // not reachable from any function go last
+    RPO,
+    // per function, breadth-first from its tail node along
+    // the inputs, i.e. the order SubGraph iterates through.
+    // Nodes not reachable from any function go last
+    BFS
+  };
+  void MarkNodeDead(Node* N);
+  size_t getNumDeadNodes() const { return NumTombstones; }
+  // return number of nodes swept
+  size_t CollectDeadNodes(NodeOrder Order = NodeOrder::Unchanged);
+  // Only sweep if tombstones take up a quarter of the node list
+  // or more, so that the cost of a sweep is amortized over the
+  // nodes it removes. Return number of nodes swept
+  size_t MaybeCollectDeadNodes();
+
+  // Sweep the tombstones, sort nodes in Order, then move them
+  // into a fresh arena in that order and renumber their ids
+  // accordingly. So that nodes of a function are packed close
+  // to each other in memory, and dense side tables indexed
+  // by ids are traversed sequentially.
+  // Return the new address of each node indexed by its old
+  // id, null for the swept ones. All the other Node pointers,
+  // ids, NodeMaps and SubGraph snapshots held outside of this
+  // Graph are invalidated. Can't be called while a checkpoint
+  // is open
+  std::vector<Node*> Compact(NodeOrder Order = NodeOrder::RPO);
+
+  // Nodes are garbage if they can't be reached from any function
+  // and are neither global values nor global variables.
+  // While tracked, every node that loses a user, gets inserted, or
+  // stops being a global variable or function is appended to Sink,
+  // these are the only nodes that might have become garbage.
+  // Pass null to stop tracking. Return the previous sink
+  std::vector<Node*>* TrackGarbageCandidates(std::vector<Node*>* Sink) {
+    std::swap(GarbageCandidates, Sink);
+    return Sink;
+  }
+  // claim that there is no garbage at this moment
+  void MarkGarbageFree() {
+    GarbageFreeEpoch = MutationEpoch;
+    GarbageFreeNumIds = NodeIdCounter;
+    GarbageFree = true;
+  }
+  // true if nothing has changed since the last MarkGarbageFree
+  bool IsGarbageFree() const {
+    return GarbageFree &&
+           GarbageFreeEpoch == MutationEpoch &&
+           GarbageFreeNumIds == NodeIdCounter;
+  }
+
   void MarkGlobalVar(Node* N);
   bool IsGlobalVar(Node* N) const { return GlobalVariables.count(N); }
   void ReplaceGlobalVar(Node* Old, Node* New);
@@ -179,9 +506,60 @@ public:
     return llvm::make_range(global_var_begin(), global_var_end());
   }
 
+  // Global value numbering is opt-in. When enabled, builders
+  // of pure binary nodes return the existing node with the
+  // same opcode and operands instead of creating a new one.
+  // Note that it shouldn't be enabled while inserting copies
+  // into a schedule (e.g. register allocation). Disabling it
+  // keeps the recorded numbers, so they're still found once it's
+  // enabled again
+  void SetValueNumbering(bool Enable) { ValueNumbering = Enable; }
+  bool IsValueNumbering() const { return ValueNumbering; }
+  // Nodes whose operands are all global values (e.g. constants)
+  // might be built by several functions, and sharing one between
+  // them would break the boundaries of subregions. So these are
+  // only numbered within the function set here, which can be
+  // identified by any of its nodes. The VirtFuncPrototype builder
+  // sets it to the new Start node, and passes running on one
+  // function at a time set it to its tail node
+  void SetValueNumberingFunction(Node* Func) { ValueNumberFunc = Func; }
+  Node* getValueNumberingFunction() const { return ValueNumberFunc; }
+  // return nullptr if there is no such node
+  Node* FindValueNumber(IrOpcode::ID OC, Node* LHS, Node* RHS,
+                        bool Commutative);
+  void RecordValueNumber(Node* N, bool Commutative);
+
+  // Enable or disable value numbering in a scope
+  class ValueNumberingScope {
+    Graph& G;
+    bool PrevState;
+
+  public:
+    ValueNumberingScope(Graph& graph, bool Enable)
+      : G(graph), PrevState(G.IsValueNumbering()) {
+      G.SetValueNumbering(Enable);
+    }
+    ~ValueNumberingScope() { G.SetValueNumbering(PrevState); }
+  };
+
   void AddSubRegion(const SubGraph& SubG);
   void AddSubRegion(SubGraph&& SubG);
 
+  // Speculative edits. After a Checkpoint, changes on edges,
+  // node insertions, kills and removals are recorded in a
+  // journal. Rollback reverts them and Commit keeps them, both
+  // cost proportional to the number of edits since then.
+  // Checkpoints can be nested.
+  // Nodes inserted after the checkpoint become tombstones when
+  // rolled back. Removed nodes are only swept after the outermost
+  // checkpoint is closed.
+  // Note that the order of users and the value numbering
+  // table are not restored
+  void Checkpoint() { Checkpoints.push_back(Journal.size()); }
+  void Commit();
+  void Rollback();
+  bool HasCheckpoint() const { return !Checkpoints.empty(); }
+
   size_t getNumConstStr() const {
     return ConstStrPool.size();
   }
@@ -192,5 +570,15 @@ public:
   // dump to GraphViz graph
   void dumpGraphviz(std::ostream& OS);
 };
+
+#ifdef GRAPHIR_COMPACT_EDGES
+Node* Node::getEdgeNode(EdgeTy E) const {
+  assert(Owner && E < Owner->NodeTable.size());
+  return Owner->NodeTable[E];
+}
+Node* Node::EdgeResolver::operator()(const EdgeRecord& R) const {
+  return Owner->NodeTable[R.Target];
+}
+#endif
 } // end namespace graphir
 #endif
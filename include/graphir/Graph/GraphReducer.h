@@ -3,7 +3,13 @@
 #include "graphir/Graph/Graph.h"
 #include "graphir/Graph/Node.h"
 #include "graphir/Graph/NodeMarker.h"
+#include "graphir/Graph/ReducerStats.h"
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <type_traits>
 #include <utility>
+#include <vector>
 
 namespace graphir {
 struct GraphReduction {
@@ -21,22 +27,64 @@ private:
 // concept ReducerConcept = requires(T& R, Node* N) {
 //  { R::name() } -> const char*;
 //  { R.Reduce(N) } -> GraphReduction;
+//  // optional, opcodes Reduce might change. Nodes
+//  // with other opcodes are never passed to it
+//  { R::opcodes() } -> IrOpcode::OpcodeSet;
 // };
 
 namespace _detail {
+template<class ReducerT, class = void>
+struct reducer_opcodes {
+  static constexpr IrOpcode::OpcodeSet value = IrOpcode::OpcodeSet::all();
+};
+template<class ReducerT>
+struct reducer_opcodes<ReducerT,
+                       std::void_t<decltype(ReducerT::opcodes())>> {
+  static constexpr IrOpcode::OpcodeSet value = ReducerT::opcodes();
+};
+
 // abstract base class used to dispatch
 // polymorphically over reducer objects
 struct ReducerConcept {
+  explicit ReducerConcept(const IrOpcode::OpcodeSet& OCs
+                            = IrOpcode::OpcodeSet::all())
+    : Opcodes(OCs) {}
+  virtual ~ReducerConcept() {}
+
   virtual const char* name() const = 0;
 
   virtual GraphReduction Reduce(Node* N) = 0;
+
+  // filter nodes before making the virtual call
+  bool handles(IrOpcode::ID OC) const { return Opcodes.contains(OC); }
+  const IrOpcode::OpcodeSet& getOpcodes() const { return Opcodes; }
+
+#ifdef GRAPHIR_REDUCER_STATS
+  // where the Reduce calls are recorded, bound at
+  // the start of every run
+  ReducerStats::Entry* Stats = nullptr;
+  virtual void bindStats(ReducerStats& RS) { Stats = &RS.getEntry(name()); }
+#endif
+
+protected:
+  IrOpcode::OpcodeSet Opcodes;
 };
 
+// R->Reduce(N), recording the call if statistics are enabled
+#ifdef GRAPHIR_REDUCER_STATS
+GraphReduction reduceNode(ReducerConcept* R, Node* N);
+#else
+inline GraphReduction reduceNode(ReducerConcept* R, Node* N) {
+  return R->Reduce(N);
+}
+#endif
+
 // a template wrapper used to implement the polymorphic API
 template<class ReducerT, class... CtorArgs>
 struct ReducerModel : public ReducerConcept {
   ReducerModel(CtorArgs &&... args)
-    : Reducer(std::forward<CtorArgs>(args)...) {}
+    : ReducerConcept(reducer_opcodes<ReducerT>::value),
+      Reducer(std::forward<CtorArgs>(args)...) {}
 
   GraphReduction Reduce(Node* N) override {
     return Reducer.Reduce(N);
@@ -47,6 +95,32 @@ struct ReducerModel : public ReducerConcept {
 private:
   ReducerT Reducer;
 };
+
+// offer every node to each of the reducers in turn
+struct CompositeReducer : public ReducerConcept {
+  std::vector<std::unique_ptr<ReducerConcept>> Reducers;
+
+  CompositeReducer() : ReducerConcept(IrOpcode::OpcodeSet()) {}
+
+  void addReducer(std::unique_ptr<ReducerConcept> R) {
+    Opcodes |= R->getOpcodes();
+    Reducers.push_back(std::move(R));
+  }
+
+  const char* name() const override { return "composite"; }
+
+  GraphReduction Reduce(Node* N) override;
+
+#ifdef GRAPHIR_REDUCER_STATS
+  // the members only record their Reduce calls,
+  // visits are counted for the composite
+  void bindStats(ReducerStats& RS) override {
+    ReducerConcept::bindStats(RS);
+    for(auto& R : Reducers)
+      R->bindStats(RS);
+  }
+#endif
+};
 } // end namespace _detail
 
 /// Mixin for reducer to modify other nodes
@@ -58,6 +132,11 @@ struct GraphEditor {
     virtual void Revisit(Node* N) = 0;
 
     virtual Graph& GetGraph() = 0;
+
+    // speculative edits, see Graph::Checkpoint
+    virtual void Checkpoint() { GetGraph().Checkpoint(); }
+    virtual void Commit() { GetGraph().Commit(); }
+    virtual void Rollback() { GetGraph().Rollback(); }
   };
 
 protected:
@@ -75,6 +154,10 @@ protected:
   void Revisit(Node* N) {
     Editor->Revisit(N);
   }
+  // try some edits and revert them if they're not profitable
+  void Checkpoint() { Editor->Checkpoint(); }
+  void Commit() { Editor->Commit(); }
+  void Rollback() { Editor->Rollback(); }
   // for single node reduction
   static GraphReduction Replace(Node* N) {
     return GraphReduction(N);
@@ -86,6 +169,20 @@ protected:
 
 /// The primary graph reduction algorithm implement
 class GraphReducer : public GraphEditor::Interface {
+public:
+  // order to reduce nodes in
+  enum class WorklistOrder : uint8_t {
+    // depth-first, the most recently pushed node goes first.
+    // i.e. inputs of a node are reduced before going back to it
+    LIFO,
+    // by position in the post-order of the function (definitions
+    // before users), so inputs settle before their users are
+    // (re)visited. Nodes created during reduction take the
+    // position of the node being reduced
+    RPO
+  };
+
+private:
   enum class ReductionState : uint8_t {
     Unvisited = 0, // Default state
     Revisit,       // Revisit later
@@ -98,20 +195,83 @@ class GraphReducer : public GraphEditor::Interface {
   Graph& G;
   Node* DeadNode;
 
-  // visiting stacks
-  std::vector<Node*> ReductionStack, RevisitStack;
+  // Nodes waiting to be reduced, every operation is O(1) in LIFO
+  // order and O(log n) in RPO order. A node is pushed at most once
+  // until it's popped, which is guarded by RSMarker
+  class Worklist {
+    struct Item {
+      uint32_t Priority;
+      // push order, to break ties in LIFO manner
+      uint32_t Seq;
+      Node* N;
+    };
+    // top is at the back in LIFO order, a heap in RPO order
+    std::vector<Item> Items;
+    uint32_t NextSeq;
+    WorklistOrder Order;
+
+    // true if A should be popped after B
+    static bool lowerPriority(const Item& A, const Item& B) {
+      return A.Priority != B.Priority? A.Priority > B.Priority
+                                     : A.Seq < B.Seq;
+    }
+
+  public:
+    explicit Worklist(WorklistOrder O) : NextSeq(0U), Order(O) {}
+
+    bool empty() const { return Items.empty(); }
+    size_t size() const { return Items.size(); }
+    Node* top() const {
+      assert(!empty());
+      return Order == WorklistOrder::LIFO? Items.back().N
+                                         : Items.front().N;
+    }
+    void push(Node* N, uint32_t Priority = 0U);
+    void pop();
+    // remove all the nodes that satisfy Pred
+    template<class PredT>
+    void remove_if(PredT Pred) {
+      Items.erase(std::remove_if(Items.begin(), Items.end(),
+                                 [&](const Item& I) { return Pred(I.N); }),
+                  Items.end());
+      if(Order == WorklistOrder::RPO)
+        std::make_heap(Items.begin(), Items.end(), lowerPriority);
+    }
+  };
+  Worklist ReductionStack;
+  // top is at the back
+  std::vector<Node*> RevisitStack;
+  // nodes of current function in post-order, collected by DFSVisit
+  std::vector<Node*> PostOrderNodes;
 
   // visiting marker
   NodeMarker<ReductionState> RSMarker;
 
+  WorklistOrder Order;
+  // RPO order only. Position in PostOrderNodes plus one indexed by
+  // node id, zero for nodes created during reduction
+  std::vector<uint32_t> Priorities;
+  // priority of the node being reduced
+  uint32_t CurPriority;
+  uint32_t getPriority(Node* N);
+
   bool DoTrimGraph;
+  // nodes that might have become garbage in this run
+  std::vector<Node*> TrimCandidates;
+
+#ifdef GRAPHIR_REDUCER_STATS
+  // entry of the reducer being run
+  ReducerStats::Entry* CurStats = nullptr;
+#endif
 
-  GraphReducer(Graph& graph, bool TrimGraph = true);
+  GraphReducer(Graph& graph, WorklistOrder Order = WorklistOrder::LIFO,
+               bool TrimGraph = true);
 
   // implement GraphEditor::Interface
   void Replace(Node* N, Node* Replacement) override;
   void Revisit(Node* N) override;
   Graph& GetGraph() override { return G; }
+  void Rollback() override;
 
   void Push(Node* N);
   void Pop();
@@ -121,12 +281,50 @@ class GraphReducer : public GraphEditor::Interface {
   void DFSVisit(SubGraph& SG, NodeMarker<ReductionState>& Marker);
 
   void runImpl(_detail::ReducerConcept* R);
+  // remove nodes that are unreachable from any function. Only
+  // look at TrimCandidates if Incremental is true, which requires
+  // the graph to be garbage free when this run started
+  void trimGraph(bool Incremental);
+  // mark the nodes that are unreachable from any function dead,
+  // return the number of them
+  size_t sweepUnreachable();
+  // mark the candidates that can no longer be reached from any
+  // function dead, and so on for their inputs, return the number
+  // of them
+  size_t collectGarbage();
+
+  template<class ReducerT>
+  std::unique_ptr<_detail::ReducerConcept> createReducer() {
+    if constexpr(std::is_constructible<ReducerT,
+                                       GraphEditor::Interface*>::value) {
+      using ModelT = _detail::ReducerModel<ReducerT, GraphEditor::Interface*>;
+      return std::make_unique<ModelT>(this);
+    } else {
+      return std::make_unique<_detail::ReducerModel<ReducerT>>();
+    }
+  }
   void runOnFunctionGraph(SubGraph& SG, _detail::ReducerConcept* R);
 
 public:
+  // Normally only the nodes touched by a run are checked for
+  // garbage at the end of it, as long as the graph was garbage
+  // free when it started. If verification is turned on, every run
+  // also sweeps the whole graph afterward and asserts that the
+  // incremental collection didn't miss anything
+  static void SetVerifyTrim(bool Verify);
+
+  // Statistics of all the runs so far, per reducer and opcode.
+  // Always empty unless built with GRAPHIR_REDUCER_STATS
+  static const ReducerStats& GetStats() { return ReducerStats::Get(); }
+  static void ResetStats() { ReducerStats::Get().clear(); }
+
   template<class ReducerT, class... Args>
   static void Run(Graph& G, Args &&... CtorArgs) {
-    GraphReducer GR(G);
+    Run<ReducerT>(G, WorklistOrder::LIFO, std::forward<Args>(CtorArgs)...);
+  }
+  template<class ReducerT, class... Args>
+  static void Run(Graph& G, WorklistOrder Order, Args &&... CtorArgs) {
+    GraphReducer GR(G, Order);
     _detail::ReducerModel<ReducerT, Args...> RM(
       std::forward<Args>(CtorArgs)...
     );
@@ -135,13 +333,33 @@ public:
 
   template<class ReducerT, class... Args>
   static void RunWithEditor(Graph& G, Args &&...CtorArgs) {
-    GraphReducer GR(G);
+    RunWithEditor<ReducerT>(G, WorklistOrder::LIFO,
+                            std::forward<Args>(CtorArgs)...);
+  }
+  template<class ReducerT, class... Args>
+  static void RunWithEditor(Graph& G, WorklistOrder Order,
+                            Args &&...CtorArgs) {
+    GraphReducer GR(G, Order);
     _detail::ReducerModel<ReducerT, GraphEditor::Interface*, Args...> RM(
       &GR, // first argument must be GraphEditor::Interface*
       std::forward<Args>(CtorArgs)...
     );
     GR.runImpl(&RM);
   }
+
+  // Run several reducers in a single fixpoint traversal. Each node
+  // is offered to the reducers in the given order until one of them
+  // replaces it. If a reducer changes the node in-place, the others
+  // get another chance on it right away.
+  // Reducers are constructed with the GraphEditor::Interface if
+  // they take one, or default constructed otherwise
+  template<class... ReducerTs>
+  static void RunAll(Graph& G, WorklistOrder Order = WorklistOrder::LIFO) {
+    GraphReducer GR(G, Order);
+    _detail::CompositeReducer CR;
+    (CR.addReducer(GR.createReducer<ReducerTs>()), ...);
+    GR.runImpl(&CR);
+  }
 };
 } // end namespace graphir
 #endif
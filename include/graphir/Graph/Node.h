@@ -3,16 +3,20 @@
 #include "graphir/Graph/Opcodes.h"
 #include "graphir/Support/Log.h"
 #include "graphir/Support/iterator_range.h"
+#include "boost/container/small_vector.hpp"
 #include "boost/container_hash/hash.hpp"
-#include "boost/iterator/filter_iterator.hpp"
+#include "boost/iterator/transform_iterator.hpp"
+#include <array>
 #include <functional>
-#include <unordered_map>
+#include <string>
 #include <vector>
 #include <utility>
 
 namespace graphir {
 // Forward declarations
 class Node;
+class Graph;
+struct AttributeBuilder;
 namespace _details {
 template<IrOpcode::ID OC,class SubT>
 struct BinOpNodeBuilder;
@@ -51,15 +55,23 @@ struct Use {
     return !(RHS == *this);
   }
 
+  // edge patcher policy that leaves edges untouched
+  struct NoPatch {
+    Use operator()(const Use& E) const { return E; }
+  };
+
+  // build the out-edges of a node. Edges are passed through
+  // PatcherT, which is a compile-time policy so that ordinary
+  // traversals pay nothing for it
+  template<class PatcherT = NoPatch>
   struct BuilderFunctor;
 };
 
+template<class PatcherT>
 struct Use::BuilderFunctor {
   Node* From;
   Use::Kind DepKind;
-
-  using PatcherTy = std::function<Use(const Use&)>;
-  PatcherTy PatchFunctor;
+  PatcherT Patcher;
 
   // will have problem if one just
   // delcare edge iterator without initialize
@@ -68,16 +80,12 @@ struct Use::BuilderFunctor {
 
   explicit
   BuilderFunctor(Node* F, Use::Kind K = K_NONE,
-                 PatcherTy Patcher = nullptr)
+                 const PatcherT& P = PatcherT())
     : From(F), DepKind(K),
-      PatchFunctor(Patcher) {}
+      Patcher(P) {}
 
   Use operator()(Node* To) const {
-    Use E(From, To, DepKind);
-    if(PatchFunctor)
-      return PatchFunctor(E);
-    else
-      return std::move(E);
+    return Patcher(Use(From, To, DepKind));
   }
 };
 
@@ -94,17 +102,97 @@ class Node {
   friend class NodeBuilder;
   template<IrOpcode::ID OC,class SubT>
   friend struct _details::BinOpNodeBuilder;
+  friend struct AttributeBuilder;
 
   IrOpcode::ID Op;
 
-  // used by NodeMarker
-  uint32_t MarkerData;
+  // dense id and owner assigned by Graph::InsertNode
+  uint32_t Id;
+  Graph* Owner;
+  // siblings in the per-opcode node list of the owner Graph
+  Node* PrevOfOp;
+  Node* NextOfOp;
+
+public:
+  using MarkerTy = uint32_t;
+  // number of NodeMarkers that can keep their data inside
+  // Node at the same time, the rest fall back to side tables
+  static constexpr unsigned NumMarkerSlots = 2U;
+
+private:
+  // used by NodeMarker. Data is only valid if the epoch matches
+  // the one of the NodeMarker currently holding the slot
+  struct MarkerSlot {
+    MarkerTy Epoch;
+    MarkerTy Data;
+  };
+  std::array<MarkerSlot, NumMarkerSlots> Markers;
 
   unsigned NumValueInput;
   unsigned NumControlInput;
   unsigned NumEffectInput;
 
-  std::vector<Node*> Inputs;
+#ifdef GRAPHIR_COMPACT_EDGES
+  // Edges store the dense ids of nodes, which are resolved
+  // through the node table of the owner Graph. Together with
+  // the 32-bit use records below, this halves the size of edges,
+  // which dominates memory usage of large graphs
+  using EdgeTy = uint32_t;
+  // defined in Graph.h
+  inline Node* getEdgeNode(EdgeTy E) const;
+  static EdgeTy getEdge(const Node* N) {
+    assert(N->Id != InvalidId && "Node is not inserted into Graph");
+    return N->Id;
+  }
+
+  // inline buffers are padded to 8 bytes, one record each.
+  // Most of the nodes have no more than two users
+  static constexpr unsigned NumInlineInputs = 4U;
+  static constexpr unsigned NumInlineUsers = 2U;
+#else
+  using EdgeTy = Node*;
+  Node* getEdgeNode(EdgeTy E) const { return E; }
+  static EdgeTy getEdge(const Node* N) { return const_cast<Node*>(N); }
+
+  static constexpr unsigned NumInlineInputs = 4U;
+  static constexpr unsigned NumInlineUsers = 4U;
+#endif
+
+  // Use record: one side of an edge, plus the index of the
+  // record on the other side (the entry in the input node's
+  // Users for an input slot, or the input slot in the user for
+  // an entry of Users), so that an edge can be unlinked from
+  // both sides in O(1)
+  struct EdgeRecord {
+    EdgeTy Target;
+    uint32_t Peer;
+  };
+
+#ifdef GRAPHIR_COMPACT_EDGES
+  struct EdgeResolver {
+    const Graph* Owner = nullptr;
+    inline Node* operator()(const EdgeRecord& R) const;
+  };
+  EdgeResolver getEdgeResolver() const { return EdgeResolver{Owner}; }
+#else
+  struct EdgeResolver {
+    Node* operator()(const EdgeRecord& R) const { return R.Target; }
+  };
+  EdgeResolver getEdgeResolver() const { return EdgeResolver(); }
+#endif
+
+  // Most of the nodes only have a handful of inputs and users,
+  // so keep them inline and only spill to the heap for large
+  // fan-in / fan-out nodes (e.g. Phi, Merge, End and constants)
+  using EdgeListTy
+    = boost::container::small_vector<EdgeRecord, NumInlineInputs>;
+  using UserListTy
+    = boost::container::small_vector<EdgeRecord, NumInlineUsers>;
+
+  EdgeListTy Inputs;
+  Node* getInput(unsigned rawInputIdx) const {
+    return getEdgeNode(Inputs[rawInputIdx].Target);
+  }
   inline Use::Kind inputUseKind(unsigned rawInputIdx) {
     assert(rawInputIdx < Inputs.size());
     if(rawInputIdx < NumValueInput) return Use::K_VALUE;
@@ -115,22 +203,77 @@ class Node {
     return Use::K_NONE;
   }
 
-  std::vector<Node*> Users;
+  // Users are partitioned by kind of use:
+  // [value users | control users | effect users]
+  // Note that the order within each partition is NOT stable
+  UserListTy Users;
+  Node* getUser(unsigned Idx) const {
+    return getEdgeNode(Users[Idx].Target);
+  }
+  unsigned NumValueUser;
+  unsigned NumControlUser;
+  unsigned NumEffectUser;
+
+  // first index and size of the Users partition for a kind of use
+  unsigned userBegin(Use::Kind UseKind) const;
+  unsigned& userCount(Use::Kind UseKind);
+  void moveUseRecord(unsigned From, unsigned To);
+
+  // notify the owner Graph that edges have changed
+  void bumpMutationEpoch();
+
+  // link/unlink input slot to/from the use list of its input node
+  void addUse(unsigned InputIdx);
+  void removeUse(unsigned InputIdx);
+  // fixup use records of input slots start from InputIdx
+  // after they were shifted
+  void updateUseIndices(unsigned InputIdx);
+  // move the use records of a kind (or all kinds if K_NONE)
+  // to the end of the corresponding partitions of To, and
+  // rewire the users, all in one pass
+  void transferUsers(Node* To, Use::Kind UseKind);
+  // called by Graph::InsertNode
+  void linkInputs();
+
+  // first raw index and number of input slots of a kind
+  unsigned inputBegin(Use::Kind UseKind) const;
+  unsigned& inputCount(Use::Kind UseKind);
 
   void setNodeInput(unsigned Index, unsigned Size, unsigned Offset,
                     Node* NewNode);
-  void appendNodeInput(unsigned& Size, unsigned Offset,
-                       Node* NewNode);
+  // insert before the Index-th input of a kind
+  void insertNodeInput(Use::Kind UseKind, unsigned Index, Node* NewNode);
   void removeNodeInput(unsigned Index, unsigned& Size, unsigned Offset);
   void removeNodeInputAll(Node* N, unsigned& Size, unsigned Offset);
-  void cleanupRemoveNodeInput(Node* OldInput);
+
+  // immediate payload of constant nodes, so that reading
+  // a constant doesn't need to look it up in the Graph pools
+  union {
+    int32_t IntVal;
+    // interned by Graph
+    const std::string* StrVal;
+  } Imm;
+
+public:
+  using AttrMaskTy = uint16_t;
+
+private:
+  // one bit for each kind of Attribute attached to this node,
+  // so that querying an attribute is a single bit test
+  AttrMaskTy AttrMask;
 
   bool IsKilled;
+  // removed from Graph but still in its node list,
+  // waiting for Graph::CollectDeadNodes
+  bool IsTombstone;
 
 public:
-  using MarkerTy = uint32_t;
+  using IdTy = uint32_t;
+  static constexpr IdTy InvalidId = ~IdTy(0);
 
   IrOpcode::ID getOp() const { return Op; }
+  IdTy getId() const { return Id; }
+  Graph* getGraph() const { return Owner; }
 
   inline
   unsigned getNumValueInput() const { return NumValueInput; }
@@ -141,17 +284,17 @@ public:
 
   Node* getValueInput(unsigned Index) const {
     assert(Index < NumValueInput);
-    return Inputs.at(Index);
+    return getEdgeNode(Inputs.at(Index).Target);
   }
 
   Node* getControlInput(unsigned Index) const {
     assert(Index < NumControlInput);
-    return Inputs.at(NumValueInput + Index);
+    return getEdgeNode(Inputs.at(NumValueInput + Index).Target);
   }
 
   Node* getEffectInput(unsigned Index) const {
     assert(Index < NumEffectInput);
-    return Inputs.at(NumValueInput + NumControlInput + Index);
+    return getEdgeNode(Inputs.at(NumValueInput + NumControlInput + Index).Target);
   }
 
   // modifiers
@@ -174,39 +317,47 @@ public:
   // (remaining) users with Dead Node
   void Kill(Node* DeadNode);
   bool IsDead() const { return IsKilled; }
-
-  using input_iterator = typename decltype(Inputs)::iterator;
-  using const_input_iterator = typename decltype(Inputs)::const_iterator;
+  bool IsRemoved() const { return IsTombstone; }
+
+  using input_iterator
+    = boost::transform_iterator<EdgeResolver,
+                                typename EdgeListTy::const_iterator,
+                                Node*, Node*>;
+  using const_input_iterator = input_iterator;
+  input_iterator edge_iterator(typename EdgeListTy::const_iterator It) const {
+    return input_iterator(It, getEdgeResolver());
+  }
   llvm::iterator_range<input_iterator> inputs() {
-    return llvm::make_range(Inputs.begin(), Inputs.end());
+    return llvm::make_range(input_begin(), input_end());
   }
   llvm::iterator_range<const_input_iterator> inputs() const {
-    return llvm::make_range(Inputs.cbegin(), Inputs.cend());
+    return llvm::make_range(edge_iterator(Inputs.cbegin()),
+                            edge_iterator(Inputs.cend()));
   }
-  input_iterator input_begin() { return Inputs.begin(); }
-  input_iterator input_end() { return Inputs.end(); }
+  input_iterator input_begin() { return edge_iterator(Inputs.begin()); }
+  input_iterator input_end() { return edge_iterator(Inputs.end()); }
   size_t input_size() const { return Inputs.size(); }
 
   // iterators
   llvm::iterator_range<input_iterator>
   value_inputs() {
-    return llvm::make_range(Inputs.begin(),
-                            Inputs.begin() + NumValueInput);
+    return llvm::make_range(input_begin(),
+                            input_begin() + NumValueInput);
   }
   input_iterator value_input_begin() { return value_inputs().begin(); }
   input_iterator value_input_end() { return value_inputs().end(); }
 
   llvm::iterator_range<input_iterator>
   control_inputs() {
-    return llvm::make_range(Inputs.begin() + NumValueInput,
-                            Inputs.begin() + NumValueInput + NumControlInput);
+    return llvm::make_range(input_begin() + NumValueInput,
+                            input_begin() + NumValueInput + NumControlInput);
   }
   input_iterator control_input_begin() { return control_inputs().begin(); }
   input_iterator control_input_end() { return control_inputs().end(); }
 
   llvm::iterator_range<input_iterator>
   effect_inputs() {
-    auto IB = Inputs.begin();
+    auto IB = input_begin();
     return llvm::make_range(IB + NumValueInput + NumControlInput,
                             IB + NumValueInput + NumControlInput
                             + NumEffectInput);
@@ -214,130 +365,259 @@ public:
   input_iterator effect_input_begin() { return effect_inputs().begin(); }
   input_iterator effect_input_end() { return effect_inputs().end(); }
 
-  struct is_value_use {
-    Node* SrcNode;
-    is_value_use(Node* Src) : SrcNode(Src) {}
-
-    bool operator()(Node* Sink) {
-      for(Node* Dep : Sink->value_inputs()) {
-        if(Dep == SrcNode) return true;
-      }
-      return false;
-    }
-  };
-  struct is_control_use {
-    Node* SrcNode;
-    is_control_use(Node* Src) : SrcNode(Src) {}
-
-    bool operator()(Node* Sink) {
-      for(Node* Dep : Sink->control_inputs()) {
-        if(Dep == SrcNode) return true;
-      }
-      return false;
-    }
-  };
-  struct is_effect_use {
-    Node* SrcNode;
-    is_effect_use(Node* Src) : SrcNode(Src) {}
-
-    bool operator()(Node* Sink) {
-      for(Node* Dep : Sink->effect_inputs()) {
-        if(Dep == SrcNode) return true;
-      }
-      return false;
-    }
-  };
-  using user_iterator = typename decltype(Users)::iterator;
-  using value_user_iterator
-    = boost::filter_iterator<is_value_use, user_iterator>;
-  using control_user_iterator
-    = boost::filter_iterator<is_control_use, user_iterator>;
-  using effect_user_iterator
-    = boost::filter_iterator<is_effect_use, user_iterator>;
+  // users are partitioned by the kind of use, so these
+  // are just sub-ranges of Users
+  using user_iterator = input_iterator;
+  using value_user_iterator = user_iterator;
+  using control_user_iterator = user_iterator;
+  using effect_user_iterator = user_iterator;
 
   llvm::iterator_range<user_iterator>
   users() {
-    return llvm::make_range(Users.begin(), Users.end());
+    return llvm::make_range(edge_iterator(Users.begin()),
+                            edge_iterator(Users.end()));
   }
   llvm::iterator_range<value_user_iterator>
-  value_users();
+  value_users() {
+    auto UB = edge_iterator(Users.begin());
+    return llvm::make_range(UB, UB + NumValueUser);
+  }
   llvm::iterator_range<control_user_iterator>
-  control_users();
+  control_users() {
+    auto UB = edge_iterator(Users.begin());
+    return llvm::make_range(UB + NumValueUser,
+                            UB + NumValueUser + NumControlUser);
+  }
   llvm::iterator_range<effect_user_iterator>
-  effect_users();
+  effect_users() {
+    auto UB = edge_iterator(Users.begin());
+    return llvm::make_range(UB + NumValueUser + NumControlUser,
+                            edge_iterator(Users.end()));
+  }
 
   size_t user_size() const { return Users.size(); }
 
   Node()
     : Op(IrOpcode::None),
-      MarkerData(0U),
+      Id(InvalidId),
+      Owner(nullptr),
+      PrevOfOp(nullptr),
+      NextOfOp(nullptr),
+      Markers(),
       NumValueInput(0),
       NumControlInput(0),
       NumEffectInput(0),
-      IsKilled(false) {}
+      NumValueUser(0),
+      NumControlUser(0),
+      NumEffectUser(0),
+      Imm(),
+      AttrMask(0U),
+      IsKilled(false),
+      IsTombstone(false) {}
 
   Node(IrOpcode::ID OC)
     : Op(OC),
-      MarkerData(0U),
+      Id(InvalidId),
+      Owner(nullptr),
+      PrevOfOp(nullptr),
+      NextOfOp(nullptr),
+      Markers(),
       NumValueInput(0),
       NumControlInput(0),
       NumEffectInput(0),
-      IsKilled(false) {}
+      NumValueUser(0),
+      NumControlUser(0),
+      NumEffectUser(0),
+      Imm(),
+      AttrMask(0U),
+      IsKilled(false),
+      IsTombstone(false) {}
 
   Node(IrOpcode::ID OC,
        const std::vector<Node*>& Values,
        const std::vector<Node*>& Controls = {},
        const std::vector<Node*>& Effects = {});
 
+  // Nodes always live in the arena of their owner Graph.
+  // i.e. Use `new (G) Node(...)` to create one
+  static void* operator new(size_t Size, Graph* G);
+  // only called when the constructor throws
+  static void operator delete(void*, Graph*) {}
+  // memory is reclaimed along with the Graph arena
+  static void operator delete(void* Ptr) = delete;
+
   bool ReplaceUseOfWith(Node* From, Node* To, Use::Kind UseKind);
   // replace this node with Replacement in all its users
   void ReplaceWith(Node* Replacement, Use::Kind UseKind = Use::K_NONE);
 };
 
-template<typename ValueT>
+/// Bidirectional map between Node and ValueT. Pairs are stored
+/// densely and both directions are looked up with open addressing
+/// (linear probing) tables of indices into the pairs, so a lookup is
+/// a single probe sequence without any per-entry allocation.
+/// Note that pointers returned by find_value are invalidated
+/// by insert and erase.
+template<typename ValueT, class ValueHash = std::hash<ValueT>>
 class NodeBiMap {
-  std::unordered_map<Node*, ValueT> Node2Value;
-  using N2VPairTy
-    = typename decltype(Node2Value)::value_type;
-  std::unordered_map<ValueT, Node*> Value2Node;
+  struct Entry {
+    Node* N;
+    ValueT Value;
+    size_t ValueHashVal;
+  };
+  std::vector<Entry> Entries;
+
+  // index + 1 into Entries, zero for empty slot
+  using SlotTy = uint32_t;
+  std::vector<SlotTy> NodeSlots, ValueSlots;
+
+  // scramble bits since both pointers and integers
+  // have poor low bits
+  static size_t mix(size_t H) {
+    uint64_t X = H;
+    X ^= X >> 33;
+    X *= 0xff51afd7ed558ccdULL;
+    X ^= X >> 33;
+    return static_cast<size_t>(X);
+  }
+  static size_t hashNode(const Node* N) {
+    return mix(std::hash<const Node*>{}(N));
+  }
+  static size_t hashValue(const ValueT& V) {
+    return mix(ValueHash{}(V));
+  }
+
+  size_t mask() const { return NodeSlots.size() - 1U; }
+
+  // return the slot holding N or the empty slot to place it
+  size_t probeNode(const Node* N) const {
+    size_t i = hashNode(N) & mask();
+    while(NodeSlots[i] && Entries[NodeSlots[i] - 1U].N != N)
+      i = (i + 1U) & mask();
+    return i;
+  }
+  size_t probeValue(const ValueT& V, size_t H) const {
+    size_t i = H & mask();
+    while(ValueSlots[i]) {
+      const auto& E = Entries[ValueSlots[i] - 1U];
+      if(E.ValueHashVal == H && E.Value == V) break;
+      i = (i + 1U) & mask();
+    }
+    return i;
+  }
+
+  size_t homeSlot(const std::vector<SlotTy>& Slots, SlotTy S) const {
+    const auto& E = Entries[S - 1U];
+    return (&Slots == &NodeSlots? hashNode(E.N) : E.ValueHashVal) & mask();
+  }
+
+  // backward shift deletion, so no tombstones are needed
+  void clearSlot(std::vector<SlotTy>& Slots, size_t i) {
+    for(size_t j = (i + 1U) & mask(); Slots[j]; j = (j + 1U) & mask()) {
+      size_t Home = homeSlot(Slots, Slots[j]);
+      // move it back if its home is not in the cyclic range (i, j]
+      bool InRange = i <= j? (Home > i && Home <= j)
+                           : (Home > i || Home <= j);
+      if(!InRange) {
+        Slots[i] = Slots[j];
+        i = j;
+      }
+    }
+    Slots[i] = 0U;
+  }
+
+  void grow() {
+    size_t NewSize = NodeSlots.empty()? 16U : NodeSlots.size() * 2U;
+    NodeSlots.assign(NewSize, 0U);
+    ValueSlots.assign(NewSize, 0U);
+    for(auto i = 0U; i < Entries.size(); ++i) {
+      NodeSlots[probeNode(Entries[i].N)] = i + 1U;
+      ValueSlots[probeValue(Entries[i].Value, Entries[i].ValueHashVal)]
+        = i + 1U;
+    }
+  }
+
+  void eraseAt(size_t NodeSlot) {
+    size_t Idx = NodeSlots[NodeSlot] - 1U;
+    clearSlot(NodeSlots, NodeSlot);
+    clearSlot(ValueSlots,
+              probeValue(Entries[Idx].Value, Entries[Idx].ValueHashVal));
+    // fill the hole with the last entry
+    size_t Last = Entries.size() - 1U;
+    if(Idx != Last) {
+      auto& E = Entries[Last];
+      NodeSlots[probeNode(E.N)] = Idx + 1U;
+      ValueSlots[probeValue(E.Value, E.ValueHashVal)] = Idx + 1U;
+      Entries[Idx] = std::move(E);
+    }
+    Entries.pop_back();
+  }
 
 public:
   ValueT* find_value(Node* N) const {
-    return Node2Value.count(N)?
-            const_cast<ValueT*>(&Node2Value.at(N)) :
-            nullptr;
+    if(Entries.empty()) return nullptr;
+    auto S = NodeSlots[probeNode(N)];
+    return S? const_cast<ValueT*>(&Entries[S - 1U].Value) : nullptr;
   }
 
   Node* find_node(const ValueT& V) const {
-    return Value2Node.count(V)?
-            const_cast<Node*>(Value2Node.at(V)) :
-            nullptr;
-  }
-
-  bool insert(const N2VPairTy& Pair, bool overwrite = false) {
-    if(overwrite) {
-      Node2Value[Pair.first] = Pair.second;
-      Value2Node[Pair.second] = Pair.first;
-    } else {
-      if(Node2Value.count(Pair.first) ||
-         Value2Node.count(Pair.second)) {
-        return false;
+    if(Entries.empty()) return nullptr;
+    auto S = ValueSlots[probeValue(V, hashValue(V))];
+    return S? Entries[S - 1U].N : nullptr;
+  }
+
+  // if overwrite is true, existing pairs of either the node
+  // or the value are replaced
+  bool insert(const std::pair<Node*, ValueT>& Pair, bool overwrite = false) {
+    if(!Entries.empty()) {
+      auto NS = probeNode(Pair.first);
+      auto H = hashValue(Pair.second);
+      auto VS = probeValue(Pair.second, H);
+      if(NodeSlots[NS] || ValueSlots[VS]) {
+        if(!overwrite) return false;
+        erase(Pair.first);
+        if(auto* Other = find_node(Pair.second)) erase(Other);
       }
-      Node2Value.insert(Pair);
-      Value2Node.insert(std::make_pair(Pair.second, Pair.first));
     }
+
+    // keep load factor under 3/4
+    if((Entries.size() + 1U) * 4U > NodeSlots.size() * 3U) grow();
+    auto H = hashValue(Pair.second);
+    Entries.push_back({Pair.first, Pair.second, H});
+    NodeSlots[probeNode(Pair.first)] = Entries.size();
+    ValueSlots[probeValue(Pair.second, H)] = Entries.size();
     return true;
   }
 
   void erase(Node* N) {
-    if(Node2Value.count(N)) {
-      auto Val = Node2Value.at(N);
-      Node2Value.erase(N);
-      Value2Node.erase(Val);
-    }
+    if(Entries.empty()) return;
+    auto NS = probeNode(N);
+    if(NodeSlots[NS]) eraseAt(NS);
   }
 
-  size_t size() const { return Value2Node.size(); }
+  size_t size() const { return Entries.size(); }
+
+  // rewrite the node and value of every pair with
+  // Fn(Node*&, ValueT&), pairs are dropped if it returns false.
+  // Used to fix up the pairs after nodes are relocated
+  template<class FuncT>
+  void rewrite(FuncT Fn) {
+    size_t NumKept = 0U;
+    for(auto i = 0U; i < Entries.size(); ++i) {
+      auto& E = Entries[i];
+      if(!Fn(E.N, E.Value)) continue;
+      E.ValueHashVal = hashValue(E.Value);
+      if(i != NumKept) Entries[NumKept] = std::move(E);
+      ++NumKept;
+    }
+    Entries.resize(NumKept);
+    NodeSlots.assign(NodeSlots.size(), 0U);
+    ValueSlots.assign(ValueSlots.size(), 0U);
+    for(auto i = 0U; i < Entries.size(); ++i) {
+      NodeSlots[probeNode(Entries[i].N)] = i + 1U;
+      ValueSlots[probeValue(Entries[i].Value, Entries[i].ValueHashVal)]
+        = i + 1U;
+    }
+  }
 };
 
 } // end namespace graphir
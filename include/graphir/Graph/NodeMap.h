@@ -0,0 +1,251 @@
+#ifndef GRAPHIR_GRAPH_NODEMAP_H
+#define GRAPHIR_GRAPH_NODEMAP_H
+#include "graphir/Graph/Node.h"
+#include "boost/iterator/filter_iterator.hpp"
+#include "boost/iterator/iterator_facade.hpp"
+#include <array>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace graphir {
+/// Side table keyed by Node, indexed by the dense node id
+/// instead of hashing. Storage is split into fixed-size pages
+/// allocated on demand, so references to the mapped values stay
+/// valid until they're erased, just like std::unordered_map.
+/// Iteration goes in the order of node ids.
+template<class T>
+class NodeMap {
+public:
+  using key_type = Node*;
+  using mapped_type = T;
+  // entry with null key is empty
+  using value_type = std::pair<Node*, T>;
+
+private:
+  static constexpr size_t PageShift = 7U;
+  static constexpr size_t PageSize = 1U << PageShift;
+  using PageTy = std::array<value_type, PageSize>;
+
+  std::vector<std::unique_ptr<PageTy>> Pages;
+  size_t NumEntries;
+
+  value_type* getSlot(size_t Idx) const {
+    auto PageIdx = Idx >> PageShift;
+    if(PageIdx >= Pages.size() || !Pages[PageIdx]) return nullptr;
+    return &(*Pages[PageIdx])[Idx & (PageSize - 1)];
+  }
+
+  value_type* lookup(Node* N) const {
+    assert(N && N->getId() != Node::InvalidId &&
+           "Node is not inserted into Graph");
+    auto* Slot = getSlot(N->getId());
+    return (Slot && Slot->first)? Slot : nullptr;
+  }
+
+  template<bool IsConst>
+  class iterator_impl
+    : public boost::iterator_facade<
+               iterator_impl<IsConst>,
+               typename std::conditional<IsConst,
+                                         const value_type,
+                                         value_type>::type,
+               boost::forward_traversal_tag> {
+    friend class boost::iterator_core_access;
+    friend class NodeMap;
+    template<bool>
+    friend class iterator_impl;
+
+    const NodeMap* Map;
+    size_t Idx;
+
+    iterator_impl(const NodeMap* M, size_t I)
+      : Map(M), Idx(I) { skipEmpty(); }
+
+    void skipEmpty() {
+      size_t E = Map->Pages.size() << PageShift;
+      while(Idx < E) {
+        auto* Slot = Map->getSlot(Idx);
+        if(!Slot) {
+          // skip the whole page
+          Idx = ((Idx >> PageShift) + 1) << PageShift;
+          continue;
+        }
+        if(Slot->first) break;
+        ++Idx;
+      }
+      if(Idx > E) Idx = E;
+    }
+
+    void increment() {
+      ++Idx;
+      skipEmpty();
+    }
+
+    bool equal(const iterator_impl& Other) const {
+      return Map == Other.Map && Idx == Other.Idx;
+    }
+
+    typename iterator_impl::reference dereference() const {
+      return *Map->getSlot(Idx);
+    }
+
+  public:
+    iterator_impl() : Map(nullptr), Idx(0U) {}
+
+    // non-const to const conversion
+    template<bool OtherConst,
+             class = typename std::enable_if<IsConst || !OtherConst>::type>
+    iterator_impl(const iterator_impl<OtherConst>& Other)
+      : Map(Other.Map), Idx(Other.Idx) {}
+  };
+
+public:
+  using iterator = iterator_impl<false>;
+  using const_iterator = iterator_impl<true>;
+
+  NodeMap() : NumEntries(0U) {}
+
+  NodeMap(const NodeMap&) = delete;
+  NodeMap& operator=(const NodeMap&) = delete;
+  NodeMap(NodeMap&& Other) = default;
+  NodeMap& operator=(NodeMap&& Other) = default;
+
+  T& operator[](Node* N) {
+    if(auto* Slot = lookup(N)) return Slot->second;
+    auto Id = N->getId();
+    auto PageIdx = Id >> PageShift;
+    if(PageIdx >= Pages.size()) Pages.resize(PageIdx + 1);
+    if(!Pages[PageIdx]) Pages[PageIdx].reset(new PageTy());
+    auto& Slot = (*Pages[PageIdx])[Id & (PageSize - 1)];
+    Slot.first = N;
+    ++NumEntries;
+    return Slot.second;
+  }
+
+  T& at(Node* N) {
+    auto* Slot = lookup(N);
+    assert(Slot && "Node not found");
+    return Slot->second;
+  }
+  const T& at(Node* N) const {
+    return const_cast<NodeMap*>(this)->at(N);
+  }
+
+  size_t count(Node* N) const { return lookup(N)? 1U : 0U; }
+
+  iterator find(Node* N) {
+    return lookup(N)? iterator(this, N->getId()) : end();
+  }
+  const_iterator find(Node* N) const {
+    return lookup(N)? const_iterator(this, N->getId()) : end();
+  }
+
+  bool insert(const value_type& Pair) {
+    if(count(Pair.first)) return false;
+    (*this)[Pair.first] = Pair.second;
+    return true;
+  }
+  bool insert(value_type&& Pair) {
+    if(count(Pair.first)) return false;
+    (*this)[Pair.first] = std::move(Pair.second);
+    return true;
+  }
+
+  size_t erase(Node* N) {
+    auto* Slot = lookup(N);
+    if(!Slot) return 0U;
+    Slot->first = nullptr;
+    Slot->second = T();
+    --NumEntries;
+    return 1U;
+  }
+
+  void clear() {
+    Pages.clear();
+    NumEntries = 0U;
+  }
+
+  size_t size() const { return NumEntries; }
+  bool empty() const { return NumEntries == 0U; }
+
+  iterator begin() { return iterator(this, 0U); }
+  iterator end() { return iterator(this, Pages.size() << PageShift); }
+  const_iterator begin() const { return const_iterator(this, 0U); }
+  const_iterator end() const {
+    return const_iterator(this, Pages.size() << PageShift);
+  }
+};
+
+/// Set of Nodes backed by a vector indexed with
+/// the dense node id
+class NodeSet {
+  // null if absent
+  std::vector<Node*> Storage;
+  size_t NumEntries;
+
+  struct is_present {
+    bool operator()(Node* N) const { return N != nullptr; }
+  };
+
+  static size_t getIndex(Node* N) {
+    assert(N && N->getId() != Node::InvalidId &&
+           "Node is not inserted into Graph");
+    return N->getId();
+  }
+
+public:
+  using iterator
+    = boost::filter_iterator<is_present, typename decltype(Storage)::iterator>;
+  using const_iterator
+    = boost::filter_iterator<is_present,
+                             typename decltype(Storage)::const_iterator>;
+
+  NodeSet() : NumEntries(0U) {}
+
+  bool insert(Node* N) {
+    auto Idx = getIndex(N);
+    if(Idx >= Storage.size()) Storage.resize(Idx + 1, nullptr);
+    if(Storage[Idx]) return false;
+    Storage[Idx] = N;
+    ++NumEntries;
+    return true;
+  }
+
+  size_t count(Node* N) const {
+    auto Idx = getIndex(N);
+    return (Idx < Storage.size() && Storage[Idx])? 1U : 0U;
+  }
+
+  size_t erase(Node* N) {
+    if(!count(N)) return 0U;
+    Storage[getIndex(N)] = nullptr;
+    --NumEntries;
+    return 1U;
+  }
+
+  void clear() {
+    Storage.clear();
+    NumEntries = 0U;
+  }
+
+  size_t size() const { return NumEntries; }
+  bool empty() const { return NumEntries == 0U; }
+
+  iterator begin() {
+    return iterator(is_present(), Storage.begin(), Storage.end());
+  }
+  iterator end() {
+    return iterator(is_present(), Storage.end(), Storage.end());
+  }
+  const_iterator begin() const {
+    return const_iterator(is_present(), Storage.cbegin(), Storage.cend());
+  }
+  const_iterator end() const {
+    return const_iterator(is_present(), Storage.cend(), Storage.cend());
+  }
+};
+} // end namespace graphir
+#endif
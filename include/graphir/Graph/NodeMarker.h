@@ -1,24 +1,40 @@
 #ifndef GRAPHIR_GRAPH_NODEMARKER_H
 #define GRAPHIR_GRAPH_NODEMARKER_H
 #include "graphir/Graph/Node.h"
+#include "graphir/Graph/NodeMap.h"
+#include <memory>
 
 namespace graphir {
 // Forward declarations
 class Graph;
 
-/// scratch data inside Node that is fast to access
-/// note that there should be only one kind of NodeMarker
-/// active at a given time
+/// scratch data inside Node that is fast to access.
+/// Each marker grabs one of the marker slots in Node and a
+/// fresh epoch, data written by previous markers in the same slot
+/// is simply treated as zero, so no reset is needed.
+/// Up to Node::NumMarkerSlots markers can be active at the same
+/// time. Markers created beyond that store their data in a
+/// side NodeMap instead, which is slower but never shared.
 class NodeMarkerBase {
 protected:
   using MarkerTy = typename Node::MarkerTy;
 
 private:
-  MarkerTy MarkerMin, MarkerMax;
+  Graph& G;
+  // Node::NumMarkerSlots if Overflow is used
+  unsigned Slot;
+  MarkerTy Epoch;
+  MarkerTy NumState;
+  std::unique_ptr<NodeMap<MarkerTy>> Overflow;
 
 public:
   NodeMarkerBase(Graph& G, unsigned NumState);
 
+  NodeMarkerBase(const NodeMarkerBase&) = delete;
+  NodeMarkerBase& operator=(const NodeMarkerBase&) = delete;
+
+  ~NodeMarkerBase();
+
   MarkerTy Get(Node* N);
 
   void Set(Node* N, MarkerTy Val);
@@ -13,30 +13,23 @@ NODE_PROPERTIES(ConstantInt) {
     : NODE_PROP_BASE(ConstantInt, N) {}
 
   template<typename T>
-  T as(const Graph& G) const {
+  T as() const {
     if(!*this) return T();
-    if(auto* V = G.ConstNumberPool.find_value(NodePtr))
-      return static_cast<T>(*V);
-    else
-      return T();
+    return static_cast<T>(NodePtr->Imm.IntVal);
   }
 };
 NODE_PROPERTIES(ConstantStr) {
   NodeProperties(Node *N)
     : NODE_PROP_BASE(ConstantStr, N) {}
 
-  const std::string& str(const Graph& G) const {
+  const std::string& str() const {
     assert(*this && "Invalid Node");
-    const auto* V = G.ConstStrPool.find_value(NodePtr);
-    assert(V && "string not found");
-    return *V;
-  }
-  const std::string str_val(const Graph& G) const {
-    if(!*this) return "";
-    if(const auto* V = G.ConstStrPool.find_value(NodePtr))
-      return *V;
-    else
-      return "";
+    assert(NodePtr->Imm.StrVal && "string not found");
+    return *NodePtr->Imm.StrVal;
+  }
+  const std::string str_val() const {
+    if(!*this || !NodePtr->Imm.StrVal) return "";
+    return *NodePtr->Imm.StrVal;
   }
 };
 
@@ -65,12 +58,7 @@ NODE_PROPERTIES(FunctionStub) {
     if(!Func)
       Func = getFunctionStart(G);
     assert(Func);
-    auto& Attrs = G.Attributes;
-    if(!Attrs.count(Func)) return false;
-    for(auto& AttrPtr : Attrs.at(Func)) {
-      if(AttrPtr->Kind() == AT) return true;
-    }
-    return false;
+    return Func->AttrMask & AttrBit<AT>;
   }
 };
 
@@ -116,10 +104,10 @@ NODE_PROPERTIES(VirtSrcDecl) {
     return NodePtr->getValueInput(0);
   }
 
-  const std::string& ident_name(const Graph& G) const {
+  const std::string& ident_name() const {
     auto* SymStrNode = getSymbolName();
     return NodeProperties<IrOpcode::ConstantStr>(SymStrNode)
-           .str(G);
+           .str();
   }
 
 };
@@ -163,12 +151,12 @@ NODE_PROPERTIES(Start) {
   NodeProperties(Node *N)
     : NODE_PROP_BASE(Start, N) {}
 
-  const std::string& name(const Graph& G) const {
+  const std::string& name() const {
     assert(NodePtr->getNumValueInput() > 0);
     auto* NameNode = NodePtr->getValueInput(0);
     assert(NameNode && NameNode->getOp() == IrOpcode::ConstantStr);
     return NodeProperties<IrOpcode::ConstantStr>(NameNode)
-           .str(G);
+           .str();
   }
 
   Node* EndNode() const {
@@ -553,9 +541,8 @@ NODE_PROPERTIES(VirtBinOps) {
     }
   }
 
-  bool IsCommutative() const {
-    if(!NodePtr) return false;
-    switch(NodePtr->getOp()) {
+  static bool IsCommutative(IrOpcode::ID OC) {
+    switch(OC) {
     case IrOpcode::BinAdd:
     case IrOpcode::BinMul:
     case IrOpcode::BinEq:
@@ -565,6 +552,10 @@ NODE_PROPERTIES(VirtBinOps) {
       return false;
     }
   }
+  bool IsCommutative() const {
+    if(!NodePtr) return false;
+    return IsCommutative(NodePtr->getOp());
+  }
 
   Node* LHS() const {
     if(NodePtr->getNumValueInput() > 0)
@@ -616,7 +607,7 @@ struct NodeBuilder<IrOpcode::Dead> {
 
   Node* Build() {
     if(!G->DeadNode) {
-      G->DeadNode = new Node(IrOpcode::Dead, {});
+      G->DeadNode = new (G) Node(IrOpcode::Dead, {});
       G->InsertNode(G->DeadNode);
     }
     return G->DeadNode;
@@ -636,7 +627,8 @@ struct NodeBuilder<IrOpcode::ConstantInt> {
       return N;
     else {
       // New constant Node
-      Node* NewN = new Node(IrOpcode::ConstantInt);
+      Node* NewN = new (G) Node(IrOpcode::ConstantInt);
+      NewN->Imm.IntVal = Val;
       G->ConstNumberPool.insert({NewN, Val});
       G->InsertNode(NewN);
       return NewN;
@@ -659,8 +651,10 @@ struct NodeBuilder<IrOpcode::ConstantStr> {
       return N;
     else {
       // New constant Node
-      Node* NewN = new Node(IrOpcode::ConstantStr);
-      G->ConstStrPool.insert({NewN, SymName});
+      Node* NewN = new (G) Node(IrOpcode::ConstantStr);
+      const auto& Str = G->ConstStrStorage.emplace_back(SymName);
+      NewN->Imm.StrVal = &Str;
+      G->ConstStrPool.insert({NewN, Str});
       G->InsertNode(NewN);
       return NewN;
     }
@@ -687,7 +681,7 @@ struct NodeBuilder<IrOpcode::FunctionStub> {
     else {
       // New function stub node
       // TODO: attribute and node update
-      Node* NewN = new Node(IrOpcode::FunctionStub);
+      Node* NewN = new (G) Node(IrOpcode::FunctionStub);
       G->FuncStubPool.insert({NewN, SG});
       G->InsertNode(NewN);
       return NewN;
@@ -714,9 +708,7 @@ struct NodeBuilder<IrOpcode::Call> {
 
   Node* Build() {
     Params.insert(Params.begin(), FuncStub);
-    auto* N = new Node(IrOpcode::Call, Params);
-    for(auto* P : Params)
-      P->Users.push_back(N);
+    auto* N = new (G) Node(IrOpcode::Call, Params);
     G->InsertNode(N);
     return N;
   }
@@ -740,8 +732,7 @@ struct NodeBuilder<IrOpcode::SrcVarDecl> {
   Node* Build() {
     Node* SymNameNode = NodeBuilder<IrOpcode::ConstantStr>(G, SymName).Build();
     // Value dependency
-    Node* VarDeclNode = new Node(IrOpcode::SrcVarDecl, {SymNameNode});
-    SymNameNode->Users.push_back(VarDeclNode);
+    Node* VarDeclNode = new (G) Node(IrOpcode::SrcVarDecl, {SymNameNode});
     G->InsertNode(VarDeclNode);
     return VarDeclNode;
   }
@@ -783,9 +774,7 @@ struct NodeBuilder<IrOpcode::SrcArrayDecl> {
     // 1..N: dimension expression
     std::vector<Node*> ValDeps{SymNode};
     ValDeps.insert(ValDeps.end(), Dims.begin(), Dims.end());
-    Node* ArrDeclNode = new Node(IrOpcode::SrcArrayDecl, ValDeps);
-    for(auto* N : ValDeps)
-      N->Users.push_back(ArrDeclNode);
+    Node* ArrDeclNode = new (G) Node(IrOpcode::SrcArrayDecl, ValDeps);
     G->InsertNode(ArrDeclNode);
     return ArrDeclNode;
   }
@@ -803,9 +792,8 @@ struct NodeBuilder<IrOpcode::SrcInitialArray> {
       ArrayDecl(Decl) {}
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::SrcInitialArray,
+    auto* N = new (G) Node(IrOpcode::SrcInitialArray,
                        {ArrayDecl});
-    ArrayDecl->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -832,10 +820,15 @@ struct BinOpNodeBuilder {
   }
 
   Node* Build() {
-    auto* BinOp = new Node(OC, {LHSNode, RHSNode});
-    LHSNode->Users.push_back(BinOp);
-    RHSNode->Users.push_back(BinOp);
+    bool Commutative = NodeProperties<IrOpcode::VirtBinOps>::IsCommutative(OC);
+    if(G->IsValueNumbering()) {
+      if(auto* N = G->FindValueNumber(OC, LHSNode, RHSNode, Commutative))
+        return N;
+    }
+    auto* BinOp = new (G) Node(OC, {LHSNode, RHSNode});
     G->InsertNode(BinOp);
+    if(G->IsValueNumbering())
+      G->RecordValueNumber(BinOp, Commutative);
     return BinOp;
   }
 
@@ -891,12 +884,10 @@ struct NodeBuilder<IrOpcode::SrcVarAccess> {
 
     std::vector<Node*> Effects;
     if(EffectDep) Effects.push_back(EffectDep);
-    auto* N = new Node(IrOpcode::SrcVarAccess,
+    auto* N = new (G) Node(IrOpcode::SrcVarAccess,
                        {VarDecl},// value inputs
                        {}/*control inputs*/,
                        Effects/*effect inputs*/);
-    VarDecl->Users.push_back(N);
-    if(EffectDep) EffectDep->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -946,13 +937,10 @@ struct NodeBuilder<IrOpcode::SrcArrayAccess> {
     ValDeps.insert(ValDeps.end(), Dims.begin(), Dims.end());
     std::vector<Node*> EffectDeps;
     if(EffectDep) EffectDeps.push_back(EffectDep);
-    Node* ArrAccessNode = new Node(IrOpcode::SrcArrayAccess,
+    Node* ArrAccessNode = new (G) Node(IrOpcode::SrcArrayAccess,
                                    ValDeps, // value dependencies
                                    {}, // control dependencies
                                    EffectDeps); // effect dependencies
-    for(auto* N : ValDeps)
-      N->Users.push_back(ArrAccessNode);
-    if(EffectDep) EffectDep->Users.push_back(ArrAccessNode);
     G->InsertNode(ArrAccessNode);
     return ArrAccessNode;
   }
@@ -977,10 +965,8 @@ struct NodeBuilder<IrOpcode::SrcAssignStmt> {
   }
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::SrcAssignStmt,
+    auto* N = new (G) Node(IrOpcode::SrcAssignStmt,
                        {DestNode, SrcNode});
-    DestNode->Users.push_back(N);
-    SrcNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1003,9 +989,8 @@ struct NodeBuilder<IrOpcode::VirtIfBranches> {
 
   Node* Build() {
     assert(IfNode && "If node cannot be null");
-    auto* N = new Node(BranchKind? IrOpcode::IfTrue : IrOpcode::IfFalse,
+    auto* N = new (G) Node(BranchKind? IrOpcode::IfTrue : IrOpcode::IfFalse,
                        {}, {IfNode});
-    IfNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1029,9 +1014,8 @@ struct NodeBuilder<IrOpcode::If> {
 
   Node* Build() {
     assert(Predicate && "condition can not be null");
-    auto* N = new Node(IrOpcode::If,
+    auto* N = new (G) Node(IrOpcode::If,
                        {Predicate});
-    Predicate->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1050,10 +1034,8 @@ struct NodeBuilder<IrOpcode::Merge> {
   }
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::Merge,
+    auto* N = new (G) Node(IrOpcode::Merge,
                        {}, Ctrls);
-    for(auto* Ctrl : Ctrls)
-      Ctrl->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1073,10 +1055,8 @@ struct NodeBuilder<IrOpcode::EffectMerge> {
   }
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::EffectMerge,
+    auto* N = new (G) Node(IrOpcode::EffectMerge,
                        {}, {}, Effects);
-    for(auto* Effect : Effects)
-      Effect->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1107,14 +1087,9 @@ struct NodeBuilder<IrOpcode::Phi> {
 
   Node* Build() {
     assert(MergeNode && "PHI require control merge point");
-    auto* N = new Node(IrOpcode::Phi,
+    auto* N = new (G) Node(IrOpcode::Phi,
                        ValueDeps, {MergeNode},
                        EffectDeps);
-    MergeNode->Users.push_back(N);
-    for(auto* VD : ValueDeps)
-      VD->Users.push_back(N);
-    for(auto* ED : EffectDeps)
-      ED->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1134,8 +1109,7 @@ struct NodeBuilder<IrOpcode::Argument> {
   Node* Build() {
     auto* NameStrNode = NodeBuilder<IrOpcode::ConstantStr>(G, SrcArgName)
                         .Build();
-    auto* N = new Node(IrOpcode::Argument, {NameStrNode});
-    NameStrNode->Users.push_back(N);
+    auto* N = new (G) Node(IrOpcode::Argument, {NameStrNode});
     G->InsertNode(N);
     return N;
   }
@@ -1174,13 +1148,12 @@ struct NodeBuilder<IrOpcode::VirtFuncPrototype> {
     }
 
     // Start node has effect dependency on arguments
-    auto* StartNode = new Node(IrOpcode::Start,
+    auto* StartNode = new (G) Node(IrOpcode::Start,
                                {NameStrNode},
                                {}, Parameters);
-    NameStrNode->Users.push_back(StartNode);
-    for(auto* PN : Parameters)
-      PN->Users.push_back(StartNode);
     G->InsertNode(StartNode);
+    // following nodes are built for this function
+    G->SetValueNumberingFunction(StartNode);
     return StartNode;
   }
 
@@ -1211,12 +1184,8 @@ struct NodeBuilder<IrOpcode::End> {
     if(!TermNodes.empty())
       CtrlDeps = std::move(TermNodes);
     CtrlDeps.insert(CtrlDeps.begin(), StartNode);
-    auto* N = new Node(IrOpcode::End,
+    auto* N = new (G) Node(IrOpcode::End,
                        {}, CtrlDeps, EffectDeps);
-    for(auto* TN : CtrlDeps)
-      TN->Users.push_back(N);
-    for(auto* E : EffectDeps)
-      E->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1236,10 +1205,9 @@ struct NodeBuilder<IrOpcode::Return> {
   Node* Build() {
     Node* N = nullptr;
     if(ReturnExpr) {
-      N = new Node(IrOpcode::Return, {ReturnExpr});
-      ReturnExpr->Users.push_back(N);
+      N = new (G) Node(IrOpcode::Return, {ReturnExpr});
     } else {
-      N = new Node(IrOpcode::Return, {});
+      N = new (G) Node(IrOpcode::Return, {});
     }
     G->InsertNode(N);
     return N;
@@ -1271,13 +1239,11 @@ struct NodeBuilder<IrOpcode::Loop> {
     auto* IfFalse = NodeBuilder<IrOpcode::VirtIfBranches>(G, false)
                     .IfStmt(IfNode)
                     .Build();
-    auto* LoopNode = new Node(IrOpcode::Loop, {},
+    auto* LoopNode = new (G) Node(IrOpcode::Loop, {},
                               // backedge is always behind LastCtrlPoint!
                               {LastCtrlPoint, IfTrue});
-    IfNode->appendControlInput(LoopNode);
-    LastCtrlPoint->Users.push_back(LoopNode);
-    IfTrue->Users.push_back(LoopNode);
     G->InsertNode(LoopNode);
+    IfNode->appendControlInput(LoopNode);
     return LoopNode;
   }
 
@@ -1303,9 +1269,8 @@ struct NodeBuilder<IrOpcode::Alloca> {
       AllocationSize = NodeBuilder<IrOpcode::ConstantInt>(G, 1)
                        .Build();
 
-    auto* N = new Node(IrOpcode::Alloca,
+    auto* N = new (G) Node(IrOpcode::Alloca,
                        {AllocationSize});
-    AllocationSize->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1322,10 +1287,8 @@ struct NodeBuilder<IrOpcode::MemLoad>
     : _internal::MemNodeBuilder<IrOpcode::MemLoad>(graph) {}
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::MemLoad,
+    auto* N = new (G) Node(IrOpcode::MemLoad,
                        {BaseAddrNode, OffsetNode});
-    BaseAddrNode->Users.push_back(N);
-    OffsetNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -1342,12 +1305,9 @@ struct NodeBuilder<IrOpcode::MemStore>
   }
 
   Node* Build() {
-    auto* N = new Node(IrOpcode::MemStore,
+    auto* N = new (G) Node(IrOpcode::MemStore,
                        {BaseAddrNode, OffsetNode,
                         SrcNode});
-    BaseAddrNode->Users.push_back(N);
-    OffsetNode->Users.push_back(N);
-    SrcNode->Users.push_back(N);
     G->InsertNode(N);
     return N;
   }
@@ -42,7 +42,7 @@ struct NodeBuilder {
 
   Node* Build() {
     // default implementation
-    auto* N = new Node(OC, {});
+    auto* N = new (G) Node(OC, {});
     G->InsertNode(N);
     return N;
   }
@@ -1,5 +1,7 @@
 #ifndef GRAPHIR_GRAPH_OPCODES_H
 #define GRAPHIR_GRAPH_OPCODES_H
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
 
 namespace graphir {
@@ -32,10 +34,103 @@ enum ID : unsigned {
 #define VIRT_OP(OC) Virt##OC,
 #include "Opcodes.def"
 #define VIRT_OP(OC) Virt##OC,
+#include "DLXOpcodes.def"
+
+  // number of IDs above
+  NumOpcodes
+};
+
+/// Fixed size bitmap over opcode IDs, usable in constant
+/// expressions so sets can be computed at compile time
+class OpcodeSet {
+  static constexpr unsigned NumWords = (NumOpcodes + 63U) / 64U;
+  uint64_t Words[NumWords];
+
+public:
+  constexpr OpcodeSet() : Words{} {}
+  constexpr OpcodeSet(std::initializer_list<ID> OCs) : Words{} {
+    for(auto OC : OCs)
+      Words[OC / 64U] |= uint64_t(1U) << (OC % 64U);
+  }
+
+  static constexpr OpcodeSet all() {
+    OpcodeSet S;
+    for(unsigned OC = 0U; OC < NumOpcodes; ++OC)
+      S.Words[OC / 64U] |= uint64_t(1U) << (OC % 64U);
+    return S;
+  }
+
+  constexpr bool contains(ID OC) const {
+    return OC < NumOpcodes &&
+           ((Words[OC / 64U] >> (OC % 64U)) & 1U);
+  }
+
+  constexpr OpcodeSet operator|(const OpcodeSet& Other) const {
+    OpcodeSet S;
+    for(auto i = 0U; i < NumWords; ++i)
+      S.Words[i] = Words[i] | Other.Words[i];
+    return S;
+  }
+  constexpr OpcodeSet& operator|=(const OpcodeSet& Other) {
+    for(auto i = 0U; i < NumWords; ++i)
+      Words[i] |= Other.Words[i];
+    return *this;
+  }
+
+  constexpr bool operator==(const OpcodeSet& Other) const {
+    for(auto i = 0U; i < NumWords; ++i)
+      if(Words[i] != Other.Words[i]) return false;
+    return true;
+  }
+  constexpr bool operator!=(const OpcodeSet& Other) const {
+    return !(*this == Other);
+  }
+};
+
+/// Opcode groups, one per category in the .def files
+constexpr OpcodeSet CommonOps {
+#define COMMON_OP(OC) OC,
+#include "Opcodes.def"
+};
+constexpr OpcodeSet ConstOps {
+#define CONST_OP(OC) OC,
+#include "Opcodes.def"
+};
+constexpr OpcodeSet ControlOps {
+#define CONTROL_OP(OC) OC,
+#include "Opcodes.def"
+};
+constexpr OpcodeSet MemoryOps {
+#define MEMORY_OP(OC) OC,
+#include "Opcodes.def"
+};
+constexpr OpcodeSet InterprocOps {
+#define INTERPROC_OP(OC) OC,
+#include "Opcodes.def"
+};
+constexpr OpcodeSet SrcOps {
+#define SRC_OP(OC) Src##OC,
+#include "Opcodes.def"
+};
+constexpr OpcodeSet DLXArithOps {
+#define DLX_ARITH_OP(OC)  \
+  DLX##OC,  \
+  DLX##OC##I,
+#include "DLXOpcodes.def"
+};
+// all the non-virtual DLX opcodes
+constexpr OpcodeSet DLXOps {
+#define DLX_ARITH_OP(OC)  \
+  DLX##OC,  \
+  DLX##OC##I,
+#define DLX_COMMON(OC) DLX##OC,
+#define DLX_CONST(OC) DLX_COMMON(OC)
 #include "DLXOpcodes.def"
 };
 
 std::ostream& Print(const Graph& G, std::ostream& OS, Node* N);
+// name of the enumerator, without any node specific detail
+const char* GetName(ID OC);
 } // end namespace IrOpcode
 } // end namespace graphir
 #endif
@@ -0,0 +1,98 @@
+#ifndef GRAPHIR_GRAPH_REDUCERSTATS_H
+#define GRAPHIR_GRAPH_REDUCERSTATS_H
+#include "graphir/Graph/Opcodes.h"
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string>
+
+namespace graphir {
+/// Statistics of GraphReducer runs, keyed by reducer name and
+/// broken down by the opcode of the node being reduced.
+/// They're only collected if the library is built with
+/// GRAPHIR_REDUCER_STATS, otherwise the hooks in GraphReducer
+/// are compiled out and the collector always stays empty.
+/// Not thread safe, which is fine as long as reductions are
+/// applied serially
+class ReducerStats {
+public:
+#ifdef GRAPHIR_REDUCER_STATS
+  static constexpr bool Enabled = true;
+#else
+  static constexpr bool Enabled = false;
+#endif
+
+  struct Counters {
+    // nodes taken off the worklist, skipped ones included
+    uint64_t NumVisits = 0U;
+    uint64_t NumReduces = 0U;
+    // Reduce returned a different node
+    uint64_t NumReplacements = 0U;
+    // Reduce changed the node itself
+    uint64_t NumInPlaceChanges = 0U;
+    // nodes scheduled for another visit
+    uint64_t NumRevisits = 0U;
+    // time spent in Reduce, in milliseconds
+    double ReduceTime = 0.0;
+
+    Counters& operator+=(const Counters& Other);
+  };
+
+  struct Entry {
+    uint64_t NumRuns = 0U;
+    // of the reduction worklist, over all the runs
+    size_t MaxWorklistSize = 0U;
+    // time of the whole runs, trimming included, in milliseconds
+    double WallTime = 0.0;
+    std::array<Counters, IrOpcode::NumOpcodes> PerOpcode;
+
+    Counters& operator[](IrOpcode::ID OC) { return PerOpcode[OC]; }
+    const Counters& operator[](IrOpcode::ID OC) const {
+      return PerOpcode[OC];
+    }
+    // sum over all the opcodes
+    Counters total() const;
+  };
+
+private:
+  std::map<std::string, Entry> Entries;
+
+public:
+  // the collector GraphReducer reports to
+  static ReducerStats& Get();
+
+  // create the entry if there is none
+  Entry& getEntry(const std::string& ReducerName) {
+    return Entries[ReducerName];
+  }
+  // nullptr if the reducer hasn't been run
+  const Entry* lookup(const std::string& ReducerName) const;
+
+  const std::map<std::string, Entry>& entries() const { return Entries; }
+  bool empty() const { return Entries.empty(); }
+  void clear() { Entries.clear(); }
+
+  // one object per reducer, with its totals and an "opcodes"
+  // object holding the counters of every opcode it has seen
+  void dumpJSON(std::ostream& OS) const;
+};
+
+namespace _detail {
+// measure the time since construction, in milliseconds
+class StatsTimer {
+  using ClockTy = std::chrono::steady_clock;
+  ClockTy::time_point Start;
+
+public:
+  StatsTimer() : Start(ClockTy::now()) {}
+
+  double elapsed() const {
+    return std::chrono::duration<double, std::milli>(ClockTy::now() - Start)
+           .count();
+  }
+};
+} // end namespace _detail
+} // end namespace graphir
+#endif
@@ -2,8 +2,6 @@
 #define GRAPHIR_GRAPH_REDUCTIONS_CSE_H
 #include "graphir/Graph/GraphReducer.h"
 #include "graphir/Graph/Node.h"
-#include <unordered_map>
-#include <set>
 
 namespace graphir {
 class CSEReducer : public GraphEditor {
@@ -12,11 +10,10 @@ class CSEReducer : public GraphEditor {
   using node_hash_type = size_t;
   node_hash_type GetNodeHash(Node* N);
 
-  // IrOpcode::ID -> Nodes w/ corresponding opcode
-  std::unordered_map<unsigned, std::set<Node*>> NodeOpMap;
   NodeBiMap<node_hash_type> NodeHashMap;
 
-  void RevisitNodes(unsigned OC, Node* Except);
+  // revisit other nodes with opcode OC
+  void RevisitNodes(IrOpcode::ID OC, Node* Except);
 
   GraphReduction ReduceArithmetic(Node* N);
   GraphReduction ReduceMemoryLoad(Node* N);
@@ -25,6 +22,11 @@ public:
   static constexpr
   const char* name() { return "cse"; }
 
+  static constexpr
+  IrOpcode::OpcodeSet opcodes() {
+    return IrOpcode::CommonOps | IrOpcode::OpcodeSet{IrOpcode::MemLoad};
+  }
+
   CSEReducer(GraphEditor::Interface* editor);
 
   GraphReduction Reduce(Node* N);
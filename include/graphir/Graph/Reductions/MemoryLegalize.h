@@ -10,6 +10,9 @@ struct MemoryLegalize : public GraphEditor {
   static constexpr
   const char* name() { return "memory-legalize"; }
 
+  static constexpr
+  IrOpcode::OpcodeSet opcodes() { return {IrOpcode::MemStore}; }
+
   GraphReduction Reduce(Node* N);
 
 private:
@@ -18,6 +18,11 @@ public:
   static constexpr
   const char* name() { return "peephole"; }
 
+  static constexpr
+  IrOpcode::OpcodeSet opcodes() {
+    return IrOpcode::CommonOps | IrOpcode::OpcodeSet{IrOpcode::Phi};
+  }
+
   GraphReduction Reduce(Node* N);
 };
 } // end namespace graphir
@@ -22,6 +22,13 @@ public:
   static constexpr
   const char* name() { return "value-promotion"; }
 
+  static constexpr
+  IrOpcode::OpcodeSet opcodes() {
+    return {IrOpcode::SrcAssignStmt, IrOpcode::SrcVarAccess,
+            IrOpcode::SrcArrayDecl, IrOpcode::SrcArrayAccess,
+            IrOpcode::Phi};
+  }
+
   GraphReduction Reduce(Node* N);
 };
 } // end namespace graphir
@@ -0,0 +1,131 @@
+#ifndef GRAPHIR_SUPPORT_ALLOCATOR_H
+#define GRAPHIR_SUPPORT_ALLOCATOR_H
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace graphir {
+/// Bump pointer allocator that carves objects out of
+/// big slabs. Objects are never freed individually, all
+/// the slabs are released at once when the allocator is
+/// destroyed or Reset().
+template<size_t SlabSize = 64 * 1024>
+class BumpPtrAllocatorImpl {
+  std::vector<void*> Slabs;
+  // slabs for requests larger than SlabSize
+  std::vector<void*> CustomSlabs;
+
+  char *CurPtr, *End;
+
+  size_t BytesAllocated;
+
+  static void* AllocateSlab(size_t Size) {
+    if(void* Slab = std::malloc(Size)) return Slab;
+    throw std::bad_alloc();
+  }
+
+  static char* AlignPtr(char* Ptr, size_t Alignment) {
+    assert(Alignment && !(Alignment & (Alignment - 1)) &&
+           "Alignment should be power of two");
+    auto Addr = reinterpret_cast<uintptr_t>(Ptr);
+    return reinterpret_cast<char*>((Addr + Alignment - 1) & ~(Alignment - 1));
+  }
+
+  void StartNewSlab() {
+    auto* Slab = static_cast<char*>(AllocateSlab(SlabSize));
+    Slabs.push_back(Slab);
+    CurPtr = Slab;
+    End = Slab + SlabSize;
+  }
+
+  void FreeSlabs() {
+    for(auto* Slab : Slabs) std::free(Slab);
+    for(auto* Slab : CustomSlabs) std::free(Slab);
+    Slabs.clear();
+    CustomSlabs.clear();
+  }
+
+public:
+  BumpPtrAllocatorImpl()
+    : CurPtr(nullptr), End(nullptr),
+      BytesAllocated(0U) {}
+
+  BumpPtrAllocatorImpl(const BumpPtrAllocatorImpl&) = delete;
+  BumpPtrAllocatorImpl& operator=(const BumpPtrAllocatorImpl&) = delete;
+
+  BumpPtrAllocatorImpl(BumpPtrAllocatorImpl&& Other)
+    : Slabs(std::move(Other.Slabs)),
+      CustomSlabs(std::move(Other.CustomSlabs)),
+      CurPtr(Other.CurPtr), End(Other.End),
+      BytesAllocated(Other.BytesAllocated) {
+    Other.Slabs.clear();
+    Other.CustomSlabs.clear();
+    Other.CurPtr = Other.End = nullptr;
+    Other.BytesAllocated = 0U;
+  }
+
+  BumpPtrAllocatorImpl& operator=(BumpPtrAllocatorImpl&& Other) {
+    if(this == &Other) return *this;
+    FreeSlabs();
+    Slabs = std::move(Other.Slabs);
+    CustomSlabs = std::move(Other.CustomSlabs);
+    CurPtr = Other.CurPtr;
+    End = Other.End;
+    BytesAllocated = Other.BytesAllocated;
+    Other.Slabs.clear();
+    Other.CustomSlabs.clear();
+    Other.CurPtr = Other.End = nullptr;
+    Other.BytesAllocated = 0U;
+    return *this;
+  }
+
+  ~BumpPtrAllocatorImpl() { FreeSlabs(); }
+
+  void* Allocate(size_t Size, size_t Alignment) {
+    BytesAllocated += Size;
+
+    char* Ptr = AlignPtr(CurPtr, Alignment);
+    if(CurPtr && Ptr + Size <= End) {
+      CurPtr = Ptr + Size;
+      return Ptr;
+    }
+
+    size_t PaddedSize = Size + Alignment - 1;
+    if(PaddedSize > SlabSize) {
+      // too big, put it in its own slab
+      auto* Slab = static_cast<char*>(AllocateSlab(PaddedSize));
+      CustomSlabs.push_back(Slab);
+      return AlignPtr(Slab, Alignment);
+    }
+
+    StartNewSlab();
+    Ptr = AlignPtr(CurPtr, Alignment);
+    assert(Ptr + Size <= End && "Unable to allocate memory!");
+    CurPtr = Ptr + Size;
+    return Ptr;
+  }
+
+  template<class T>
+  T* Allocate(size_t Num = 1) {
+    return static_cast<T*>(Allocate(Num * sizeof(T), alignof(T)));
+  }
+
+  // release all the memory, note that destructors
+  // of the allocated objects are NOT called
+  void Reset() {
+    FreeSlabs();
+    CurPtr = End = nullptr;
+    BytesAllocated = 0U;
+  }
+
+  size_t getNumSlabs() const { return Slabs.size() + CustomSlabs.size(); }
+  size_t getBytesAllocated() const { return BytesAllocated; }
+};
+
+using BumpPtrAllocator = BumpPtrAllocatorImpl<>;
+} // end namespace graphir
+#endif
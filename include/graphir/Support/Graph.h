@@ -2,10 +2,11 @@
 #define GRAPHIR_SUPPORT_GRAPH_H
 #include "boost/iterator/iterator_facade.hpp"
 #include "boost/graph/properties.hpp"
+#include "boost/property_map/property_map.hpp"
 #include "graphir/Graph/Node.h"
 #include "graphir/Support/type_traits.h"
+#include <memory>
 #include <vector>
-#include <set>
 
 namespace graphir {
 // map from vertex or edge to an unique id
@@ -60,7 +61,7 @@ class lazy_edge_iterator
     //if(!isValid()) return Use();
     assert(isValid() && "can not dereference invalid iterator");
     auto DepK = CurNode()->inputUseKind(CurInput);
-    return Use(CurNode(), CurNode()->Inputs.at(CurInput), DepK);
+    return Use(CurNode(), CurNode()->getInput(CurInput), DepK);
   }
 
 public:
@@ -82,101 +83,82 @@ public:
   }
 };
 
-// Basically a BFS traversal iterator
-template<class GraphT, bool IsConst,
+// Iterate through a snapshot of node list. The snapshot is shared
+// between copies so copying the iterator is cheap, and it stays
+// valid even if the owner recomputes its list.
+// A default constructed iterator represents the end of any list.
+template<bool IsConst,
          typename NodeT = graphir::conditional_t<IsConst, const Node*, Node*>>
-class lazy_node_iterator
-  : public boost::iterator_facade<lazy_node_iterator<GraphT,IsConst,NodeT>,
+class snapshot_node_iterator
+  : public boost::iterator_facade<snapshot_node_iterator<IsConst,NodeT>,
                                   NodeT, // Value type
                                   boost::forward_traversal_tag, // Traversal tag
                                   NodeT // Reference type
                                   > {
   friend class boost::iterator_core_access;
-  std::vector<NodeT> Queue;
-  // we use ADT instead of NodeMarker because
-  // the latter will make empty iterator(i.e. default ctor)
-  // more difficult
-  std::set<NodeT> Visited;
-
-  void Enqueue(NodeT N) {
-    Queue.push_back(N);
-    Visited.insert(N);
-  }
+  using ListTy = std::vector<Node*>;
+  std::shared_ptr<const ListTy> List;
+  size_t Idx, EndIdx;
 
-  bool equal(const lazy_node_iterator& Other) const {
-    if(Queue.size() != Other.Queue.size()) return false;
-    if(!Queue.size()) return true;
-    // deep compare
-    for(auto I1 = Queue.cbegin(), I2 = Other.Queue.cbegin(),
-             E1 = Queue.cend(), E2 = Other.Queue.cend();
-        I1 != E1 && I2 != E2; ++I1, ++I2) {
-      if(*I1 != *I2) return false;
-    }
-    return true;
+  bool isEnd() const { return !List || Idx >= EndIdx; }
+
+  bool equal(const snapshot_node_iterator& Other) const {
+    if(isEnd() || Other.isEnd()) return isEnd() == Other.isEnd();
+    return List == Other.List && Idx == Other.Idx;
   }
 
   NodeT dereference() const {
-    assert(!Queue.empty());
-    return Queue.front();
+    assert(!isEnd());
+    return (*List)[Idx];
   }
 
-  void increment() {
-    NodeT Top = Queue.front();
-    Queue.erase(Queue.begin());
-    for(NodeT N : Top->inputs()) {
-      if(Visited.count(N)) continue;
-      Enqueue(N);
-    }
-  }
+  void increment() { ++Idx; }
 
 public:
-  lazy_node_iterator() = default;
-  explicit lazy_node_iterator(NodeT EndNode) {
-    Enqueue(EndNode);
-  }
+  snapshot_node_iterator() : Idx(0U), EndIdx(0U) {}
+  explicit snapshot_node_iterator(std::shared_ptr<const ListTy> L)
+    : List(std::move(L)), Idx(0U), EndIdx(List? List->size() : 0U) {}
+  // only iterate through [Begin, End) of the list
+  snapshot_node_iterator(std::shared_ptr<const ListTy> L,
+                         size_t Begin, size_t End)
+    : List(std::move(L)), Idx(Begin), EndIdx(End) {}
 };
 
-// since boost::depth_first_search has some really STUPID
-// copy by value ColorMap parameter, we need some stub/proxy
-// to hold map storage across several usages.
-template<class T, class VertexTy>
-struct StubColorMap {
-  using value_type = boost::default_color_type;
-  using reference = value_type&;
-  using key_type = VertexTy*;
-  struct category : public boost::read_write_property_map_tag {};
-
-  StubColorMap(T& Impl) : Storage(Impl) {}
-  StubColorMap() = delete;
-  StubColorMap(const StubColorMap& Other) = default;
-
-  reference get(const key_type& key) const {
-    return const_cast<reference>(Storage.at(key));
-  }
-  void put(const key_type& key, const value_type& val) {
-    Storage[key] = val;
+// dense id of a vertex, used to index DenseVertexMap
+inline size_t dense_vertex_id(const Node* N) { return N->getId(); }
+
+// Vertex property map backed by a vector indexed by the dense
+// id of vertices, so that reading and writing are O(1) without
+// hashing. Since BGL algorithms take property maps by value,
+// copies share the same storage. The storage is sized upfront
+// and never grows, so references handed out stay valid
+template<class VertexT, class ValueT>
+struct DenseVertexMap
+  : public boost::put_get_helper<ValueT&, DenseVertexMap<VertexT, ValueT>> {
+  using key_type = VertexT*;
+  using value_type = ValueT;
+  using reference = ValueT&;
+  using category = boost::lvalue_property_map_tag;
+
+  explicit DenseVertexMap(size_t NumIds = 0U,
+                          const ValueT& Default = ValueT())
+    : Storage(std::make_shared<std::vector<ValueT>>(NumIds, Default)) {}
+  // cover all the vertices of g
+  template<class GraphT>
+  explicit DenseVertexMap(const GraphT& g, const ValueT& Default = ValueT())
+    : DenseVertexMap(dense_vertex_id_bound(g), Default) {}
+
+  reference operator[](const key_type& Key) const {
+    size_t Idx = dense_vertex_id(Key);
+    assert(Idx < Storage->size() && "Vertex id out of range");
+    return (*Storage)[Idx];
   }
 
 private:
-  T& Storage;
+  std::shared_ptr<std::vector<ValueT>> Storage;
 };
 
-// it is very strange that both StubColorMap and graph_id_map<G,T>
-// are PropertyMapConcept, but the get() function for the former one
-// should be defined in namespace graphir :\
-/// ColorMap PropertyMap
-template<class T, class Vertex>
-inline typename graphir::StubColorMap<T,Vertex>::reference
-get(const graphir::StubColorMap<T,Vertex>& pmap,
-    const typename graphir::StubColorMap<T,Vertex>::key_type& key) {
-  return pmap.get(key);
-}
-
-template<class T, class Vertex> inline
-void put(graphir::StubColorMap<T,Vertex>& pmap,
-         const typename graphir::StubColorMap<T,Vertex>::key_type& key,
-         const typename graphir::StubColorMap<T,Vertex>::value_type& val) {
-  return pmap.put(key, val);
-}
+// color map for DFS and BFS on Graph and SubGraph
+using NodeColorMap = DenseVertexMap<Node, boost::default_color_type>;
 } // end namespace graphir
 #endif
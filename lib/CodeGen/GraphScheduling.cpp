@@ -63,54 +63,13 @@ private:
 };
 
 void GraphSchedule::SortRPONodes() {
-  auto BackEdgePatcher = [](const Use& OrigEdge) -> Use {
-    auto* Source = OrigEdge.Source;
-    NodeProperties<IrOpcode::Phi> PNP(Source);
-    if(PNP && PNP.CtrlPivot()->getOp() == IrOpcode::Loop) {
-      // check if it is backedge
-      Node* Backedge = nullptr;
-      if(Source->getNumValueInput() &&
-         !Source->getNumEffectInput()) {
-        // normal value phi
-        assert(Source->getNumValueInput() >= 2);
-        // backedge is always the second input
-        Backedge = Source->getValueInput(1);
-      } else {
-        // effect phi
-        assert(Source->getNumEffectInput() >= 2);
-        Backedge = Source->getEffectInput(1);
-      }
-      if(Backedge == OrigEdge.Dest) {
-        // reverse!
-        Use Copy(OrigEdge);
-        Copy.Source = OrigEdge.Dest;
-        Copy.Dest = OrigEdge.Source;
-        return std::move(Copy);
-      }
-    } else if(Source->getOp() == IrOpcode::Loop) {
-      assert(Source->getNumControlInput() >= 2);
-      auto* Backedge = Source->getControlInput(1);
-      if(Backedge == OrigEdge.Dest) {
-        // reverse!
-        Use Copy(OrigEdge);
-        Copy.Source = OrigEdge.Dest;
-        Copy.Dest = OrigEdge.Source;
-        return std::move(Copy);
-      }
-    }
-    return OrigEdge;
-  };
-  getSubGraph().SetEdgePatcher(BackEdgePatcher);
-
   RPONodesVisitor::PostEntity PE;
   RPONodesVisitor Vis(RPONodes, PE);
-  std::unordered_map<Node*, boost::default_color_type> ColorStorage;
-  StubColorMap<decltype(ColorStorage), Node> ColorMap(ColorStorage);
-  boost::depth_first_search(getSubGraph(), Vis, std::move(ColorMap));
+  NodeColorMap ColorMap(G.getNumNodeIds());
+  SubGraphView<BackEdgeReversed> SGV(getSubGraph());
+  boost::depth_first_search(SGV, Vis, std::move(ColorMap));
   assert(PE.StartNode && PE.EndNode);
 
-  getSubGraph().ClearEdgePatcher();
-
   RPONodes.insert(RPONodes.begin(), PE.StartNode);
   RPONodes.push_back(PE.EndNode);
 }
@@ -133,7 +92,7 @@ size_t GraphSchedule::getWordAllocaSize() {
       assert(Size->getOp() == IrOpcode::ConstantInt &&
              "dynamic size allocation?");
       TotalSize +=
-        NodeProperties<IrOpcode::ConstantInt>(Size).as<size_t>(G);
+        NodeProperties<IrOpcode::ConstantInt>(Size).as<size_t>();
     }
   }
   // ceil(TotalSize / 4)
@@ -943,7 +902,7 @@ std::ostream& GraphSchedule::printBlock(std::ostream& OS, BasicBlock* BB) {
       if(VI->getOp() == IrOpcode::ConstantInt) {
         OS << "#"
            << NodeProperties<IrOpcode::ConstantInt>(VI)
-              .as<int32_t>(G);
+              .as<int32_t>();
       } else if(NodeProperties<IrOpcode::VirtDLXRegisters>(VI)) {
         //IrOpcode::Print(G, OS, VI);
         auto Offset = static_cast<unsigned>(VI->getOp() - IrOpcode::DLXr0);
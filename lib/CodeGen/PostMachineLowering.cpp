@@ -1,6 +1,7 @@
 #include "graphir/Graph/NodeUtils.h"
 #include "graphir/CodeGen/DLXNodeUtils.h"
 #include "graphir/CodeGen/PostMachineLowering.h"
+#include <unordered_map>
 
 using namespace graphir;
 
@@ -27,12 +28,20 @@ void PostMachineLowering::ControlFlowLowering() {
     }
   };
 
+  // blocks terminated by If
+  std::unordered_map<BasicBlock*, Node*> BlockIfs;
+  for(auto* N : Schedule.getSubGraph().nodes_of(IrOpcode::If)) {
+    if(auto* BB = Schedule.MapBlock(N))
+      BlockIfs[BB] = N;
+  }
+
   // {old node, new node or null, which means remove old node}
   std::vector<std::pair<Node*, Node*>> Staging;
   for(auto* BB : Schedule.rpo_blocks()) {
     auto BBRPOIdx = BB->getRPOIndex();
-    for(auto* N : BB->nodes()) {
-      if(N->getOp() != IrOpcode::If) continue;
+    auto IfIt = BlockIfs.find(BB);
+    if(IfIt != BlockIfs.end()) {
+      auto* N = IfIt->second;
       auto* Zero = NodeBuilder<IrOpcode::ConstantInt>(&G, 0)
                    .Build();
       // retreive branch targets
@@ -192,6 +201,10 @@ void PostMachineLowering::Trimming() {
 }
 
 void PostMachineLowering::Run() {
+  // nodes are inserted at specific positions in the
+  // schedule, they can't be shared
+  Graph::ValueNumberingScope NoGVN(G, false);
+
   // lowering branches and insert
   // BB jumps
   ControlFlowLowering();
@@ -66,11 +66,11 @@ bool PostRALowering::TrimNode(Node* N) {
 }
 
 // constant zero or zero register
-inline bool IsZero(Node* N, const Graph& G) {
+inline bool IsZero(Node* N) {
   if(N->getOp() == IrOpcode::DLXr0) return true;
   return (N->getOp() == IrOpcode::ConstantInt &&
           NodeProperties<IrOpcode::ConstantInt>(N)
-          .as<uint32_t>(G) == 0U);
+          .as<uint32_t>() == 0U);
 }
 
 bool PostRALowering::VisitDLXAdd(Node* N) {
@@ -81,7 +81,7 @@ bool PostRALowering::VisitDLXAdd(Node* N) {
   assert(N->getNumValueInput() == 3);
   // registers have been commited, RHS is the
   // third operand
-  if(IsZero(N->getValueInput(2), G) &&
+  if(IsZero(N->getValueInput(2)) &&
      N->getValueInput(0) == N->getValueInput(1)) {
     // remove
     Schedule.RemoveNode(BB, N);
@@ -52,7 +52,7 @@ GraphReduction PreMachineLowering::SelectArithmetic(Node* N) {
     }
 
     auto RHSInt = NodeProperties<IrOpcode::ConstantInt>(RHSVal)
-                  .as<int32_t>(G);
+                  .as<int32_t>();
     double Exp = std::log2(RHSInt);
     double FloatIntExp;
     if(N->getOp() == IrOpcode::BinMul &&
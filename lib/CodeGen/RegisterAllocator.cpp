@@ -2,6 +2,7 @@
 #include "graphir/CodeGen/Targets.h"
 #include "graphir/Graph/NodeUtils.h"
 #include <algorithm>
+#include <map>
 
 using namespace graphir;
 
@@ -668,8 +669,23 @@ void LinearScanRegisterAllocator<T>::Allocate() {
     return;
   }
 
+  // moves must not be shared
+  Graph::ValueNumberingScope NoGVN(G, false);
+
+  // only visit blocks that have PHIs, in RPO
+  std::vector<BasicBlock*> PHIBlocks;
+  for(auto* N : Schedule.getSubGraph().nodes_of(IrOpcode::Phi)) {
+    if(auto* BB = Schedule.MapBlock(N))
+      PHIBlocks.push_back(BB);
+  }
+  std::sort(PHIBlocks.begin(), PHIBlocks.end(),
+            [](BasicBlock* LHS, BasicBlock* RHS) {
+              return LHS->getRPOIndex() < RHS->getRPOIndex();
+            });
+  PHIBlocks.erase(std::unique(PHIBlocks.begin(), PHIBlocks.end()),
+                  PHIBlocks.end());
   std::vector<Node*> PHINodes;
-  for(auto* BB : Schedule.rpo_blocks()) {
+  for(auto* BB : PHIBlocks) {
     for(auto* N : BB->nodes()) {
       if(N->getOp() == IrOpcode::Phi &&
          N->getNumValueInput() && !N->getNumEffectInput()) {
@@ -22,7 +22,7 @@ uint16_t Parser::GetNodeIdx(Node* N) {
   return NodeIdxMarker->Get(N);
 }
 uint16_t Parser::GetCurrentNodeIdx() {
-  return GetNodeIdx(G.getNode(G.node_size() - 1));
+  return GetNodeIdx(G.getLastNode());
 }
 
 Node* Parser::getInitialValue(Node* Decl) {
@@ -163,9 +163,9 @@ bool Parser::Parse(bool StepLexer) {
       // lowering to memory load/store later
       NodeProperties<IrOpcode::VirtSrcDecl> DNP(GV);
       auto* NewDecl = NodeBuilder<IrOpcode::SrcArrayDecl>(&G)
-                      .SetSymbolName(DNP.ident_name(G))
+                      .SetSymbolName(DNP.ident_name())
                       .AddConstDim(1).Build();
-      CurSymTable()[DNP.ident_name(G)] = NewDecl;
+      CurSymTable()[DNP.ident_name()] = NewDecl;
       GV->ReplaceWith(NewDecl);
       G.MarkGlobalVar(NewDecl);
     } else {
@@ -5,7 +5,10 @@ using namespace graphir;
 
 // will clear the Attrs buffer in the current builder
 void AttributeBuilder::Attach(Node* N) {
-  auto& AttrList = G.Attributes[N];
-  AttrList.splice(AttrList.end(), std::move(Attrs));
-  AttrSet.clear();
+  N->AttrMask |= AttrSet;
+  if(!Attrs.empty()) {
+    auto& AttrList = G.Attributes[N];
+    AttrList.splice(AttrList.end(), std::move(Attrs));
+  }
+  AttrSet = 0U;
 }
@@ -33,18 +33,116 @@ void Graph::ReplaceGlobalVar(Node* Old, Node* New) {
   if(IsGlobalVar(Old)) {
     GlobalVariables.erase(Old);
     MarkGlobalVar(New);
+    onRootRemoved(Old);
   }
 }
 
+void Graph::onRootRemoved(Node* N) {
+  if(GarbageCandidates)
+    GarbageCandidates->push_back(N);
+  else
+    // no longer known to be garbage free
+    GarbageFree = false;
+}
+
+void* Node::operator new(size_t Size, Graph* G) {
+  assert(G && "Nodes must be allocated from a Graph");
+  return G->NodeAllocator.Allocate(Size, alignof(Node));
+}
+
+Graph::~Graph() {
+  // memory will be released by the allocator
+  for(auto* N : Nodes)
+    N->~Node();
+}
+
 void Graph::InsertNode(Node* N) {
+  assert(N->Id == Node::InvalidId && "Node has been inserted");
+  N->Id = NodeIdCounter++;
+  N->Owner = this;
   Nodes.emplace_back(N);
+  NodeTable.push_back(N);
+  N->linkInputs();
+  if(!N->IsDead()) linkOpcodeList(N);
+  journal(JournalEntry::InsertNode, N);
+  if(GarbageCandidates) GarbageCandidates->push_back(N);
   if(NodeIdxMarker)
     NodeIdxMarker->Set(N, NodeIdxCounter++);
 }
 
-typename Graph::node_iterator
-Graph::RemoveNode(typename Graph::node_iterator NI) {
-  auto* N = NI->get();
+void Graph::linkOpcodeList(Node* N) {
+  if(N->Op >= OpcodeLists.size())
+    OpcodeLists.resize(N->Op + 1U);
+  linkOpcodeListAfter(N, OpcodeLists[N->Op].Tail);
+}
+
+void Graph::linkOpcodeListAfter(Node* N, Node* Prev) {
+  assert(N->Op < OpcodeLists.size());
+  auto& L = OpcodeLists[N->Op];
+  N->PrevOfOp = Prev;
+  N->NextOfOp = Prev? Prev->NextOfOp : L.Head;
+  if(Prev)
+    Prev->NextOfOp = N;
+  else
+    L.Head = N;
+  if(N->NextOfOp)
+    N->NextOfOp->PrevOfOp = N;
+  else
+    L.Tail = N;
+  ++L.Size;
+}
+
+void Graph::unlinkOpcodeList(Node* N) {
+  assert(N->Op < OpcodeLists.size());
+  auto& L = OpcodeLists[N->Op];
+  if(N->PrevOfOp)
+    N->PrevOfOp->NextOfOp = N->NextOfOp;
+  else
+    L.Head = N->NextOfOp;
+  if(N->NextOfOp)
+    N->NextOfOp->PrevOfOp = N->PrevOfOp;
+  else
+    L.Tail = N->PrevOfOp;
+  // keep NextOfOp so that iterators on N can still advance
+  N->PrevOfOp = nullptr;
+  --L.Size;
+}
+
+void Graph::onNodeKilled(Node* N) {
+  journal(JournalEntry::KillNode, N, N->PrevOfOp);
+  unlinkOpcodeList(N);
+  // even if numbering is disabled for now, the table is kept
+  ValueNumbers.erase(N);
+}
+
+bool Graph::isFunctionLocal(Node* N) const {
+  return !NodeProperties<IrOpcode::VirtGlobalValues>(N) && !IsGlobalVar(N);
+}
+
+Node* Graph::FindValueNumber(IrOpcode::ID OC, Node* LHS, Node* RHS,
+                             bool Commutative) {
+  auto Key = getValueNumberKey(OC, LHS, RHS, Commutative);
+  auto* N = ValueNumbers.find_node(Key);
+  if(!N) return nullptr;
+  // inputs might have been changed after it's recorded
+  if(N->getNumValueInput() != 2 ||
+     N->getNumControlInput() || N->getNumEffectInput() ||
+     !(getValueNumberKey(N->getOp(), N->getValueInput(0),
+                         N->getValueInput(1), Commutative) == Key)) {
+    ValueNumbers.erase(N);
+    return nullptr;
+  }
+  return N;
+}
+
+void Graph::RecordValueNumber(Node* N, bool Commutative) {
+  assert(N->getNumValueInput() == 2);
+  auto Key = getValueNumberKey(N->getOp(), N->getValueInput(0),
+                               N->getValueInput(1), Commutative);
+  ValueNumbers.insert({N, Key}, true);
+}
+
+void Graph::unlinkNode(Node* N) {
   if(!N->IsDead()) {
     auto* DeadNode = NodeBuilder<IrOpcode::Dead>(this).Build();
     N->Kill(DeadNode);
@@ -53,14 +151,352 @@ Graph::RemoveNode(typename Graph::node_iterator NI) {
   N->removeValueInputAll(DeadNode);
   N->removeEffectInputAll(DeadNode);
   N->removeControlInputAll(DeadNode);
-  return Nodes.erase(NI);
+  SubGraphNodes.erase(N);
+}
+
+typename Graph::node_iterator
+Graph::RemoveNode(typename Graph::node_iterator NI) {
+  auto Pos = NI.base() - Nodes.begin();
+  MarkNodeDead(*NI);
+  if(!shouldCollectDeadNodes())
+    return node_iterator(Nodes.begin() + Pos + 1, Nodes.end());
+  // the next node is shifted by the tombstones before it
+  Pos -= std::count_if(Nodes.begin(), Nodes.begin() + Pos,
+                       [](const Node* N) { return N->IsRemoved(); });
+  CollectDeadNodes();
+  return node_iterator(Nodes.begin() + Pos, Nodes.end());
+}
+
+void Graph::MarkNodeDead(Node* N) {
+  if(N->IsRemoved()) return;
+  unlinkNode(N);
+  N->IsTombstone = true;
+  ++NumTombstones;
+  journal(JournalEntry::MarkDead, N);
+}
+
+size_t Graph::CollectDeadNodes(NodeOrder Order) {
+  // tombstones might be revived by a rollback
+  size_t NumSwept = HasCheckpoint()? 0U : NumTombstones;
+  if(NumSwept) {
+    // compact the survivors in one pass
+    auto Dst = Nodes.begin();
+    for(auto* N : Nodes) {
+      if(N->IsRemoved()) {
+        NodeTable[N->getId()] = nullptr;
+        N->~Node();
+        continue;
+      }
+      *Dst++ = N;
+    }
+    Nodes.erase(Dst, Nodes.end());
+    NumTombstones = 0U;
+  }
+
+  if(Order == NodeOrder::RPO)
+    sortNodesRPO();
+  else if(Order == NodeOrder::BFS)
+    sortNodesBFS();
+  return NumSwept;
+}
+
+size_t Graph::MaybeCollectDeadNodes() {
+  return shouldCollectDeadNodes()? CollectDeadNodes() : 0U;
+}
+
+std::vector<Node*> Graph::Compact(NodeOrder Order) {
+  assert(!HasCheckpoint() && "Can't compact nodes in speculative edits");
+  if(Order == NodeOrder::RPO)
+    sortNodesRPO();
+  else if(Order == NodeOrder::BFS)
+    sortNodesBFS();
+
+  // move the survivors into a new arena in order. Old nodes
+  // (including tombstones) are kept around until all the
+  // references are fixed up
+  std::vector<Node*> Relocated(NodeIdCounter, nullptr);
+  BumpPtrAllocator NewAllocator;
+  std::vector<Node*> NewNodes;
+  NewNodes.reserve(Nodes.size() - NumTombstones);
+  for(auto* N : Nodes) {
+    if(N->IsRemoved()) continue;
+    auto* NewN = ::new (NewAllocator.Allocate<Node>()) Node(std::move(*N));
+    NewN->Id = NewNodes.size();
+    Relocated[N->Id] = NewN;
+    NewNodes.push_back(NewN);
+  }
+  auto relocate = [&](Node* N) -> Node* {
+    return N? Relocated[N->Id] : nullptr;
+  };
+
+  // edges of the new nodes still refer to the old ones here,
+  // so drop value numbers whose operands are not the current
+  // inputs anymore, since those operands might be gone
+  ValueNumbers.rewrite([&](Node*& N, ValueNumberKey& Key) {
+    N = relocate(N);
+    if(!N || N->getNumValueInput() != 2 ||
+       N->getNumControlInput() || N->getNumEffectInput())
+      return false;
+    auto *LHS = N->getValueInput(0), *RHS = N->getValueInput(1);
+    if(!(Key.LHS == LHS && Key.RHS == RHS) &&
+       !(Key.LHS == RHS && Key.RHS == LHS))
+      return false;
+    Key.LHS = relocate(Key.LHS);
+    Key.RHS = relocate(Key.RHS);
+    // the function is gone
+    if(Key.Func && !(Key.Func = relocate(Key.Func)))
+      return false;
+    return true;
+  });
+  ValueNumberFunc = relocate(ValueNumberFunc);
+
+  for(auto* N : NewNodes) {
+    for(auto& E : N->Inputs) {
+      auto* Input = Relocated[N->getEdgeNode(E.Target)->Id];
+      assert(Input && "Input has been removed");
+      E.Target = Node::getEdge(Input);
+    }
+    for(auto& E : N->Users) {
+      auto* Usr = Relocated[N->getEdgeNode(E.Target)->Id];
+      assert(Usr && "User has been removed");
+      E.Target = Node::getEdge(Usr);
+    }
+    if(N->IsDead()) {
+      // not in any opcode list
+      N->PrevOfOp = N->NextOfOp = nullptr;
+    } else {
+      N->PrevOfOp = relocate(N->PrevOfOp);
+      N->NextOfOp = relocate(N->NextOfOp);
+    }
+  }
+  for(auto& L : OpcodeLists) {
+    L.Head = relocate(L.Head);
+    L.Tail = relocate(L.Tail);
+  }
+
+  // side tables
+  DeadNode = relocate(DeadNode);
+  for(auto& SG : SubRegions)
+    SG.TailNode = relocate(SG.TailNode);
+  auto relocatePair = [&](Node*& N, auto&) {
+    N = relocate(N);
+    return N != nullptr;
+  };
+  ConstStrPool.rewrite(relocatePair);
+  ConstNumberPool.rewrite(relocatePair);
+  FuncStubPool.rewrite([&](Node*& N, SubGraph& SG) {
+    N = relocate(N);
+    SG.TailNode = relocate(SG.TailNode);
+    return N && SG.TailNode;
+  });
+  decltype(Attributes) NewAttributes;
+  for(auto& KV : Attributes) {
+    if(auto* NewN = relocate(KV.first))
+      NewAttributes[NewN] = std::move(KV.second);
+  }
+  Attributes = std::move(NewAttributes);
+  NodeSet NewGlobalVars;
+  for(auto* N : GlobalVariables) {
+    if(auto* NewN = relocate(N))
+      NewGlobalVars.insert(NewN);
+  }
+  GlobalVariables = std::move(NewGlobalVars);
+  SubGraphNodes.clear();
+  VisitStamps.clear();
+  CurVisitStamp = 0U;
+
+  for(auto* N : Nodes)
+    N->~Node();
+  Nodes.swap(NewNodes);
+  NodeTable = Nodes;
+  NodeIdCounter = Nodes.size();
+  NumTombstones = 0U;
+  NodeAllocator = std::move(NewAllocator);
+  ++MutationEpoch;
+  return Relocated;
+}
+
+unsigned Graph::AcquireMarkerSlot() {
+  auto FreeIt = std::find_if(MarkerSlots.begin(), MarkerSlots.end(),
+                             [](const MarkerSlotState& S) {
+                               return !S.Active;
+                             });
+  if(FreeIt == MarkerSlots.end()) return Node::NumMarkerSlots;
+
+  unsigned Slot = std::distance(MarkerSlots.begin(), FreeIt);
+  auto& S = *FreeIt;
+  if(++S.LastEpoch == 0U) {
+    // epoch wraparound. Nobody else is using this slot,
+    // so it's safe to just clear it on all the nodes
+    for(auto* N : Nodes)
+      N->Markers[Slot] = {0U, 0U};
+    S.LastEpoch = 1U;
+  }
+  S.Active = true;
+  return Slot;
+}
+
+void Graph::ReleaseMarkerSlot(unsigned Slot) {
+  assert(Slot < MarkerSlots.size() && MarkerSlots[Slot].Active);
+  MarkerSlots[Slot].Active = false;
+}
+
+void Graph::startNewVisit() {
+  // only clear the stamps on wraparound
+  if(++CurVisitStamp == 0U) {
+    std::fill(VisitStamps.begin(), VisitStamps.end(), 0U);
+    CurVisitStamp = 1U;
+  }
+  if(VisitStamps.size() < NodeIdCounter)
+    VisitStamps.resize(NodeIdCounter, 0U);
+}
+
+void Graph::sortNodesRPO() {
+  std::vector<Node*> Sorted;
+  Sorted.reserve(Nodes.size());
+  startNewVisit();
+
+  // iterative post-order DFS on inputs, so every
+  // node is placed after all of its inputs
+  // (except the ones on back edges)
+  std::vector<std::pair<Node*, unsigned>> Stack;
+  for(auto& SG : SubRegions) {
+    if(!SG.TailNode || !markVisited(SG.TailNode)) continue;
+    Stack.emplace_back(SG.TailNode, 0U);
+    while(!Stack.empty()) {
+      auto* Top = Stack.back().first;
+      auto& NextInput = Stack.back().second;
+      if(NextInput < Top->input_size()) {
+        auto* Input = Top->getInput(NextInput++);
+        if(markVisited(Input))
+          Stack.emplace_back(Input, 0U);
+      } else {
+        Sorted.push_back(Top);
+        Stack.pop_back();
+      }
+    }
+  }
+  // rest of the nodes keep their original order
+  for(auto* N : Nodes) {
+    if(markVisited(N)) Sorted.push_back(N);
+  }
+  assert(Sorted.size() == Nodes.size() &&
+         "Reachable nodes not in this Graph?");
+  Nodes.swap(Sorted);
+}
+
+void Graph::sortNodesBFS() {
+  std::vector<Node*> Sorted;
+  Sorted.reserve(Nodes.size());
+  startNewVisit();
+
+  for(auto& SG : SubRegions) {
+    if(!SG.TailNode || !markVisited(SG.TailNode)) continue;
+    // nodes of this function in Sorted are the queue
+    size_t Front = Sorted.size();
+    Sorted.push_back(SG.TailNode);
+    while(Front < Sorted.size()) {
+      auto* N = Sorted[Front++];
+      for(auto* Input : N->inputs()) {
+        if(markVisited(Input))
+          Sorted.push_back(Input);
+      }
+    }
+  }
+  // rest of the nodes keep their original order
+  for(auto* N : Nodes) {
+    if(markVisited(N)) Sorted.push_back(N);
+  }
+  assert(Sorted.size() == Nodes.size() &&
+         "Reachable nodes not in this Graph?");
+  Nodes.swap(Sorted);
 }
 
 void Graph::AddSubRegion(const SubGraph& SG) {
   SubRegions.push_back(SG);
+  journal(JournalEntry::AddSubRegion, SG.TailNode);
 }
 void Graph::AddSubRegion(SubGraph&& SG) {
   SubRegions.push_back(SG);
+  journal(JournalEntry::AddSubRegion, SG.TailNode);
+}
+
+void Graph::Commit() {
+  assert(HasCheckpoint() && "No checkpoint to commit");
+  Checkpoints.pop_back();
+  // keep the entries for the outer checkpoints
+  if(Checkpoints.empty()) Journal.clear();
+}
+
+void Graph::Rollback() {
+  assert(HasCheckpoint() && "No checkpoint to rollback");
+  IsRollingBack = true;
+  for(auto Begin = Checkpoints.back(); Journal.size() > Begin;) {
+    undo(Journal.back());
+    Journal.pop_back();
+  }
+  IsRollingBack = false;
+  Checkpoints.pop_back();
+}
+
+void Graph::undo(const JournalEntry& E) {
+  auto* N = E.N;
+  switch(E.EntryKind) {
+  case JournalEntry::SetInput:
+    N->setNodeInput(E.Slot, N->input_size(), 0U, E.Other);
+    break;
+  case JournalEntry::InsertInput: {
+    unsigned Offset = N->inputBegin(E.UseKind);
+    N->removeNodeInput(E.Slot - Offset, N->inputCount(E.UseKind), Offset);
+    break;
+  }
+  case JournalEntry::EraseInput:
+    N->insertNodeInput(E.UseKind, E.Slot - N->inputBegin(E.UseKind),
+                       E.Other);
+    break;
+  case JournalEntry::InsertNode:
+    discardNode(N);
+    break;
+  case JournalEntry::KillNode:
+    N->IsKilled = false;
+    linkOpcodeListAfter(N, E.Other);
+    break;
+  case JournalEntry::MarkDead:
+    N->IsTombstone = false;
+    --NumTombstones;
+    break;
+  case JournalEntry::AddSubRegion:
+    assert(!SubRegions.empty() && SubRegions.back().TailNode == N);
+    SubRegions.pop_back();
+    onRootRemoved(N);
+    break;
+  }
+}
+
+void Graph::discardNode(Node* N) {
+  // all of its users were either discarded or rewired
+  // back by the entries after this one
+  assert(!N->user_size() && "Discarded node still in use");
+  for(auto i = 0U, E = unsigned(N->input_size()); i < E; ++i)
+    N->removeUse(i);
+  N->Inputs.clear();
+  N->NumValueInput = N->NumControlInput = N->NumEffectInput = 0U;
+  if(!N->IsKilled) {
+    unlinkOpcodeList(N);
+    N->IsKilled = true;
+  }
+  N->IsTombstone = true;
+  ++NumTombstones;
+
+  // forget it in all the side tables
+  ConstNumberPool.erase(N);
+  ConstStrPool.erase(N);
+  FuncStubPool.erase(N);
+  ValueNumbers.erase(N);
+  Attributes.erase(N);
+  GlobalVariables.erase(N);
+  SubGraphNodes.erase(N);
+  if(DeadNode == N) DeadNode = nullptr;
 }
 
 void Graph::dumpGraphviz(std::ostream& OS) {
@@ -70,6 +506,78 @@ void Graph::dumpGraphviz(std::ostream& OS) {
                         graph_prop_writer{});
 }
 
+SubGraph::NodeListRef SubGraph::getNodeList() const {
+  if(!TailNode) return nullptr;
+  auto* G = TailNode->getGraph();
+  assert(G && "Tail node is not inserted into Graph");
+  return G->getSubGraphNodes(TailNode);
+}
+
+SubGraph::NodeListRef
+SubGraph::getNodeListOf(IrOpcode::ID OC, size_t& Begin, size_t& End) const {
+  Begin = End = 0U;
+  if(!TailNode) return nullptr;
+  auto* G = TailNode->getGraph();
+  assert(G && "Tail node is not inserted into Graph");
+  return G->getSubGraphNodesOf(TailNode, OC, Begin, End);
+}
+
 size_t SubGraph::node_size() const {
-  return std::distance(node_cbegin(), node_cend());
+  auto NodeList = getNodeList();
+  return NodeList? NodeList->size() : 0U;
+}
+
+SubGraph::NodeListRef Graph::getSubGraphNodes(Node* Tail) {
+  auto& Cache = SubGraphNodes[Tail];
+  if(Cache.NodeList && Cache.Epoch == MutationEpoch)
+    return Cache.NodeList;
+
+  // BFS, the result list itself is the queue
+  startNewVisit();
+  auto NodeList = std::make_shared<std::vector<Node*>>();
+  markVisited(Tail);
+  NodeList->push_back(Tail);
+  for(size_t i = 0U; i < NodeList->size(); ++i) {
+    for(auto* N : (*NodeList)[i]->inputs()) {
+      if(markVisited(N)) NodeList->push_back(N);
+    }
+  }
+
+  Cache.Epoch = MutationEpoch;
+  Cache.NodeList = std::move(NodeList);
+  Cache.NodeListByOp.reset();
+  return Cache.NodeList;
+}
+
+SubGraph::NodeListRef
+Graph::getSubGraphNodesOf(Node* Tail, IrOpcode::ID OC,
+                          size_t& Begin, size_t& End) {
+  auto NodeList = getSubGraphNodes(Tail);
+  auto& Cache = SubGraphNodes[Tail];
+  if(!Cache.NodeListByOp) {
+    // counting sort by opcode
+    auto& Offsets = Cache.OpOffsets;
+    Offsets.assign(OpcodeLists.size() + 1U, 0U);
+    for(auto* N : *NodeList) {
+      if(N->Op + 1U >= Offsets.size())
+        Offsets.resize(N->Op + 2U, 0U);
+      ++Offsets[N->Op + 1U];
+    }
+    for(auto i = 1U; i < Offsets.size(); ++i)
+      Offsets[i] += Offsets[i - 1U];
+    auto ByOp = std::make_shared<std::vector<Node*>>(NodeList->size());
+    std::vector<uint32_t> Pos(Offsets.begin(), Offsets.end() - 1U);
+    for(auto* N : *NodeList)
+      (*ByOp)[Pos[N->Op]++] = N;
+    Cache.NodeListByOp = std::move(ByOp);
+  }
+
+  const auto& Offsets = Cache.OpOffsets;
+  if(OC + 1U < Offsets.size()) {
+    Begin = Offsets[OC];
+    End = Offsets[OC + 1U];
+  } else {
+    Begin = End = 0U;
+  }
+  return Cache.NodeListByOp;
 }
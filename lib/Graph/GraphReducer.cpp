@@ -3,11 +3,39 @@
 #include "graphir/Graph/GraphReducer.h"
 #include "boost/graph/depth_first_search.hpp"
 #include "boost/graph/properties.hpp"
+#include <algorithm>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 #include <iostream>
 
 using namespace graphir;
 
+namespace {
+bool VerifyTrim = false;
+
+// Flag all the nodes reachable from Tail in Reached, indexed by
+// node id. Nodes shared between functions are only walked once
+void MarkReachable(Node* Tail, std::vector<bool>& Reached) {
+  auto TryMark = [&](Node* N) {
+    if(Reached[N->getId()]) return false;
+    Reached[N->getId()] = true;
+    return true;
+  };
+  std::vector<Node*> Worklist;
+  if(TryMark(Tail)) Worklist.push_back(Tail);
+  while(!Worklist.empty()) {
+    auto* N = Worklist.back();
+    Worklist.pop_back();
+    for(auto* Input : N->inputs()) {
+      if(TryMark(Input)) Worklist.push_back(Input);
+    }
+  }
+}
+} // end anonymous namespace
+
+void GraphReducer::SetVerifyTrim(bool Verify) { VerifyTrim = Verify; }
+
 struct GraphReducer::DFSVisitor
   : public boost::default_dfs_visitor {
   DFSVisitor(std::vector<Node*>& Preced,
@@ -26,12 +54,77 @@ private:
   NodeMarker<GraphReducer::ReductionState>& Marker;
 };
 
-GraphReducer::GraphReducer(Graph& graph, bool TrimGraph)
+#ifdef GRAPHIR_REDUCER_STATS
+GraphReduction _detail::reduceNode(ReducerConcept* R, Node* N) {
+  assert(R->Stats && "Statistics are not bound");
+  auto& C = (*R->Stats)[N->getOp()];
+  _detail::StatsTimer Timer;
+  auto RP = R->Reduce(N);
+  C.ReduceTime += Timer.elapsed();
+  ++C.NumReduces;
+  if(RP.Changed()) {
+    if(RP.Replacement() != N)
+      ++C.NumReplacements;
+    else
+      ++C.NumInPlaceChanges;
+  }
+  return RP;
+}
+#endif
+
+GraphReduction _detail::CompositeReducer::Reduce(Node* N) {
+  bool Changed = false;
+  auto Skip = Reducers.end();
+  for(auto RI = Reducers.begin(); RI != Reducers.end();) {
+    if(RI == Skip || !(*RI)->handles(N->getOp())) {
+      ++RI;
+      continue;
+    }
+    auto RP = reduceNode(RI->get(), N);
+    if(!RP.Changed()) {
+      ++RI;
+      continue;
+    }
+    if(RP.Replacement() != N) return RP;
+    // in-place change, rerun the other reducers on it
+    Changed = true;
+    Skip = RI;
+    RI = Reducers.begin();
+  }
+  return Changed? GraphReduction(N) : GraphReduction();
+}
+
+GraphReducer::GraphReducer(Graph& graph, WorklistOrder order,
+                           bool TrimGraph)
   : G(graph),
     DeadNode(NodeBuilder<IrOpcode::Dead>(&G).Build()),
+    ReductionStack(order),
     RSMarker(G, 4),
+    Order(order),
+    CurPriority(0U),
     DoTrimGraph(TrimGraph) {}
 
+void GraphReducer::Worklist::push(Node* N, uint32_t Priority) {
+  Items.push_back({Priority, NextSeq++, N});
+  if(Order == WorklistOrder::RPO)
+    std::push_heap(Items.begin(), Items.end(), lowerPriority);
+}
+
+void GraphReducer::Worklist::pop() {
+  assert(!empty());
+  if(Order == WorklistOrder::RPO)
+    std::pop_heap(Items.begin(), Items.end(), lowerPriority);
+  Items.pop_back();
+}
+
+uint32_t GraphReducer::getPriority(Node* N) {
+  if(Order != WorklistOrder::RPO) return 0U;
+  auto Id = N->getId();
+  if(Id < Priorities.size() && Priorities[Id])
+    return Priorities[Id] - 1U;
+  return CurPriority;
+}
+
 void GraphReducer::Replace(Node* N, Node* Replacement) {
   for(auto* Usr : N->users()) {
     Revisit(Usr);
@@ -41,21 +134,34 @@ void GraphReducer::Replace(Node* N, Node* Replacement) {
   Recurse(Replacement);
 }
 
+void GraphReducer::Rollback() {
+  G.Rollback();
+  // drop the nodes discarded by the rollback
+  auto IsDiscarded = [](Node* N) { return N->IsRemoved(); };
+  ReductionStack.remove_if(IsDiscarded);
+  RevisitStack.erase(std::remove_if(RevisitStack.begin(),
+                                    RevisitStack.end(), IsDiscarded),
+                     RevisitStack.end());
+}
+
 void GraphReducer::Revisit(Node* N) {
   if(RSMarker.Get(N) == ReductionState::Visited) {
     RSMarker.Set(N, ReductionState::Revisit);
-    RevisitStack.insert(RevisitStack.begin(), N);
+    RevisitStack.push_back(N);
+#ifdef GRAPHIR_REDUCER_STATS
+    ++(*CurStats)[N->getOp()].NumRevisits;
+#endif
   }
 }
 
 void GraphReducer::Push(Node* N) {
   RSMarker.Set(N, ReductionState::OnStack);
-  ReductionStack.insert(ReductionStack.begin(), N);
+  ReductionStack.push(N, getPriority(N));
 }
 
 void GraphReducer::Pop() {
-  auto* TopNode = ReductionStack.front();
-  ReductionStack.erase(ReductionStack.begin());
+  auto* TopNode = ReductionStack.top();
+  ReductionStack.pop();
   RSMarker.Set(TopNode, ReductionState::Visited);
 }
 
@@ -66,25 +172,43 @@ bool GraphReducer::Recurse(Node* N) {
 }
 
 void GraphReducer::DFSVisit(SubGraph& SG, NodeMarker<ReductionState>& Marker) {
-  DFSVisitor Vis(ReductionStack, Marker);
-  std::unordered_map<Node*,boost::default_color_type> ColorStorage;
-  StubColorMap<decltype(ColorStorage), Node> ColorMap(ColorStorage);
+  DFSVisitor Vis(PostOrderNodes, Marker);
+  NodeColorMap ColorMap(G.getNumNodeIds());
   boost::depth_first_search(SG, Vis, std::move(ColorMap));
 }
 
 void GraphReducer::runOnFunctionGraph(SubGraph& SG,
                                       _detail::ReducerConcept* Reducer) {
   DFSVisit(SG, RSMarker);
+  // the first node in post-order goes first
+  if(Order == WorklistOrder::RPO) {
+    Priorities.assign(G.getNumNodeIds(), 0U);
+    for(auto i = 0U; i < PostOrderNodes.size(); ++i)
+      Priorities[PostOrderNodes[i]->getId()] = i + 1U;
+  }
+  for(auto i = PostOrderNodes.size(); i > 0U; --i) {
+    auto* N = PostOrderNodes[i - 1U];
+    ReductionStack.push(N, getPriority(N));
+  }
 
   while(!ReductionStack.empty() || !RevisitStack.empty()) {
     while(!ReductionStack.empty()) {
-      Node* N = ReductionStack.front();
-      if(N->getOp() == IrOpcode::Dead) {
+      Node* N = ReductionStack.top();
+#ifdef GRAPHIR_REDUCER_STATS
+      ++(*CurStats)[N->getOp()].NumVisits;
+      CurStats->MaxWorklistSize = std::max(CurStats->MaxWorklistSize,
+                                           ReductionStack.size());
+#endif
+      // also skip the nodes no reducer cares about
+      // without going through the virtual call
+      if(N->getOp() == IrOpcode::Dead ||
+         !Reducer->handles(N->getOp())) {
         Pop();
         continue;
       }
 
-      auto RP = Reducer->Reduce(N);
+      CurPriority = getPriority(N);
+      auto RP = _detail::reduceNode(Reducer, N);
 
       if(!RP.Changed()) {
         Pop();
@@ -114,8 +238,8 @@ void GraphReducer::runOnFunctionGraph(SubGraph& SG,
     }
 
     while(!RevisitStack.empty()) {
-      Node* N = RevisitStack.front();
-      RevisitStack.erase(RevisitStack.begin());
+      Node* N = RevisitStack.back();
+      RevisitStack.pop_back();
 
       if(RSMarker.Get(N) == ReductionState::Revisit) {
         Push(N);
@@ -125,41 +249,187 @@ void GraphReducer::runOnFunctionGraph(SubGraph& SG,
 }
 
 void GraphReducer::runImpl(_detail::ReducerConcept* Reducer) {
-  for(auto& SG : G.subregions())
+#ifdef GRAPHIR_REDUCER_STATS
+  Reducer->bindStats(ReducerStats::Get());
+  CurStats = Reducer->Stats;
+  ++CurStats->NumRuns;
+  _detail::StatsTimer RunTimer;
+#endif
+  // changes made outside of reducers are not tracked
+  bool Incremental = DoTrimGraph && G.IsGarbageFree();
+  std::vector<Node*>* PrevCandidates = nullptr;
+  if(Incremental)
+    PrevCandidates = G.TrackGarbageCandidates(&TrimCandidates);
+
+  auto* PrevFunc = G.getValueNumberingFunction();
+  for(auto& SG : G.subregions()) {
+    G.SetValueNumberingFunction(SG.getTailNode());
     runOnFunctionGraph(SG, Reducer);
+  }
+  G.SetValueNumberingFunction(PrevFunc);
 
-  if(DoTrimGraph) {
-    // remove nodes that are unreachable from any function
-    NodeMarker<ReductionState> TrimMarker(G, 4);
-    for(auto& SG : G.subregions()) {
-      DFSVisit(SG, TrimMarker);
+  if(Incremental)
+    G.TrackGarbageCandidates(PrevCandidates);
+  if(DoTrimGraph) trimGraph(Incremental);
+
+#ifdef GRAPHIR_REDUCER_STATS
+  CurStats->WallTime += RunTimer.elapsed();
+#endif
+}
+
+size_t GraphReducer::sweepUnreachable() {
+  std::vector<bool> Reached(G.getNumNodeIds());
+  for(auto& SG : G.subregions())
+    MarkReachable(SG.getTailNode(), Reached);
+
+  size_t NumDead = 0U;
+  for(auto NI = G.node_begin(), NE = G.node_end(); NI != NE; ++NI) {
+    auto* N = Graph::GetNodeFromIt(NI);
+    if(!N->IsRemoved() &&
+       !Reached[N->getId()] &&
+       !NodeProperties<IrOpcode::VirtGlobalValues>(N) &&
+       !G.IsGlobalVar(N)) {
+      G.MarkNodeDead(N);
+      ++NumDead;
     }
-    for(auto NI = G.node_begin(); NI != G.node_end();) {
-      auto* N = Graph::GetNodeFromIt(NI);
-      if(TrimMarker.Get(N) == ReductionState::Unvisited &&
-         !NodeProperties<IrOpcode::VirtGlobalValues>(N) &&
-         !G.IsGlobalVar(N)) {
-        NI = G.RemoveNode(NI);
-      } else {
-        ++NI;
+  }
+  return NumDead;
+}
+
+size_t GraphReducer::collectGarbage() {
+  std::unordered_set<Node*> Tails;
+  for(auto& SG : G.subregions())
+    Tails.insert(SG.getTailNode());
+  auto IsRoot = [&](Node* N) {
+    return NodeProperties<IrOpcode::VirtGlobalValues>(N) ||
+           G.IsGlobalVar(N) || Tails.count(N);
+  };
+
+  enum class TrimState : uint8_t {
+    Unknown = 0,
+    Visiting,
+    Live,
+    Garbage
+  };
+  NodeMarker<TrimState> State(G, 4);
+
+  // Walk up the users from Start until reaching a function
+  // tail or a node known to be live. Nodes on that path are
+  // live as well, and so is every other visited node that
+  // reaches the path through its users. The rest of the visited
+  // nodes are left Visiting: all their users have been visited
+  // without finding a live one, so they're unreachable.
+  // Either way, every visited node is settled and never walked
+  // again, so the total cost is bounded by the edges around the
+  // nodes that were touched
+  struct Frame {
+    Node* N;
+    Node::user_iterator UI, UE;
+  };
+  std::vector<Frame> Path;
+  std::vector<Node*> Visited, LiveWorklist;
+  auto WalkUp = [&](Node* Start) {
+    Visited.clear();
+    auto Push = [&](Node* N) {
+      State.Set(N, TrimState::Visiting);
+      Visited.push_back(N);
+      auto Users = N->users();
+      Path.push_back({N, Users.begin(), Users.end()});
+    };
+    Push(Start);
+    while(!Path.empty()) {
+      auto& Top = Path.back();
+      if(Top.UI == Top.UE) {
+        Path.pop_back();
+        continue;
+      }
+      auto* Usr = *Top.UI++;
+      auto UsrState = State.Get(Usr);
+      if(UsrState == TrimState::Live || Tails.count(Usr)) {
+        for(auto& F : Path) {
+          State.Set(F.N, TrimState::Live);
+          LiveWorklist.push_back(F.N);
+        }
+        Path.clear();
+        break;
+      }
+      if(UsrState == TrimState::Unknown) Push(Usr);
+    }
+    while(!LiveWorklist.empty()) {
+      auto* N = LiveWorklist.back();
+      LiveWorklist.pop_back();
+      for(auto* Input : N->inputs()) {
+        if(State.Get(Input) == TrimState::Visiting) {
+          State.Set(Input, TrimState::Live);
+          LiveWorklist.push_back(Input);
+        }
       }
     }
+  };
 
-    // remove all deps to Dead node
-    auto* DeadNode = NodeBuilder<IrOpcode::Dead>(&G).Build();
-    std::vector<Node*> DeadUsrs;
-    DeadUsrs.assign(DeadNode->value_users().begin(),
-                    DeadNode->value_users().end());
-    for(auto* N : DeadUsrs)
-      N->removeValueInputAll(DeadNode);
-    DeadUsrs.assign(DeadNode->effect_users().begin(),
-                    DeadNode->effect_users().end());
-    for(auto* N : DeadUsrs)
-      N->removeEffectInputAll(DeadNode);
-    DeadUsrs.assign(DeadNode->control_users().begin(),
-                    DeadNode->control_users().end());
-    for(auto* N : DeadUsrs)
-      N->removeEffectInputAll(DeadNode);
+  std::vector<Node*> Garbage;
+  auto& Worklist = TrimCandidates;
+  while(!Worklist.empty()) {
+    auto* N = Worklist.back();
+    Worklist.pop_back();
+    if(N->IsRemoved() || State.Get(N) != TrimState::Unknown || IsRoot(N))
+      continue;
+    WalkUp(N);
+    auto NumGarbage = Garbage.size();
+    for(auto* V : Visited) {
+      if(State.Get(V) != TrimState::Visiting) continue;
+      // roots are kept, but they don't keep their inputs
+      // alive, so they're settled the same way
+      State.Set(V, TrimState::Garbage);
+      if(!IsRoot(V)) Garbage.push_back(V);
+    }
+    // inputs lost a user
+    for(auto i = NumGarbage; i < Garbage.size(); ++i) {
+      for(auto* Input : Garbage[i]->inputs())
+        if(State.Get(Input) == TrimState::Unknown)
+          Worklist.push_back(Input);
+    }
+  }
 
+  // same order as a full sweep, so the use lists of
+  // the survivors end up the same
+  std::sort(Garbage.begin(), Garbage.end(),
+            [](Node* LHS, Node* RHS) { return LHS->getId() < RHS->getId(); });
+  for(auto* N : Garbage)
+    G.MarkNodeDead(N);
+  return Garbage.size();
+}
+
+void GraphReducer::trimGraph(bool Incremental) {
+  if(Incremental) {
+    collectGarbage();
+    if(VerifyTrim) {
+      auto NumMissed = sweepUnreachable();
+      assert(!NumMissed && "Incremental trimming missed garbage");
+      (void) NumMissed;
+    }
+  } else {
+    sweepUnreachable();
   }
+  TrimCandidates.clear();
+
+  G.MaybeCollectDeadNodes();
+
+  // remove all deps to Dead node
+  auto* DeadNode = NodeBuilder<IrOpcode::Dead>(&G).Build();
+  std::vector<Node*> DeadUsrs;
+  DeadUsrs.assign(DeadNode->value_users().begin(),
+                  DeadNode->value_users().end());
+  for(auto* N : DeadUsrs)
+    N->removeValueInputAll(DeadNode);
+  DeadUsrs.assign(DeadNode->effect_users().begin(),
+                  DeadNode->effect_users().end());
+  for(auto* N : DeadUsrs)
+    N->removeEffectInputAll(DeadNode);
+  DeadUsrs.assign(DeadNode->control_users().begin(),
+                  DeadNode->control_users().end());
+  for(auto* N : DeadUsrs)
+    N->removeEffectInputAll(DeadNode);
+
+  G.MarkGarbageFree();
 }
@@ -1,4 +1,5 @@
 #include "graphir/Graph/Node.h"
+#include "graphir/Graph/Graph.h"
 #include "graphir/Support/STLExtras.h"
 #include <iterator>
 #include <utility>
@@ -10,29 +11,217 @@ Node::Node(IrOpcode::ID OC,
            const std::vector<Node*>& ControlInputs,
            const std::vector<Node*>& EffectInputs)
   : Op(OC),
-    MarkerData(0U),
+    Id(InvalidId),
+    Owner(nullptr),
+    PrevOfOp(nullptr),
+    NextOfOp(nullptr),
+    Markers(),
     NumValueInput(ValueInputs.size()),
     NumControlInput(ControlInputs.size()),
     NumEffectInput(EffectInputs.size()),
-    IsKilled(false) {
-  if(NumEffectInput > 0)
-    Inputs.insert(Inputs.begin(),
-                  EffectInputs.begin(), EffectInputs.end());
-  if(NumControlInput > 0)
-    Inputs.insert(Inputs.begin(),
-                  ControlInputs.begin(), ControlInputs.end());
-  if(NumValueInput > 0)
-    Inputs.insert(Inputs.begin(),
-                  ValueInputs.begin(), ValueInputs.end());
-}
-
-void Node::appendNodeInput(unsigned& Size, unsigned Offset,
+    NumValueUser(0),
+    NumControlUser(0),
+    NumEffectUser(0),
+    Imm(),
+    AttrMask(0U),
+    IsKilled(false),
+    IsTombstone(false) {
+  Inputs.reserve(NumValueInput + NumControlInput + NumEffectInput);
+  // use records are linked by Graph::InsertNode
+  for(auto* Input : ValueInputs)
+    Inputs.push_back({getEdge(Input), 0U});
+  for(auto* Input : ControlInputs)
+    Inputs.push_back({getEdge(Input), 0U});
+  for(auto* Input : EffectInputs)
+    Inputs.push_back({getEdge(Input), 0U});
+}
+
+void Node::linkInputs() {
+  assert(Owner && "Node is not inserted into Graph");
+  for(auto i = 0U; i < Inputs.size(); ++i)
+    addUse(i);
+}
+
+unsigned Node::userBegin(Use::Kind UseKind) const {
+  switch(UseKind) {
+  case Use::K_VALUE: return 0U;
+  case Use::K_CONTROL: return NumValueUser;
+  default:
+    assert(UseKind == Use::K_EFFECT && "Invalid Use Kind");
+    return NumValueUser + NumControlUser;
+  }
+}
+
+unsigned Node::inputBegin(Use::Kind UseKind) const {
+  switch(UseKind) {
+  case Use::K_VALUE: return 0U;
+  case Use::K_CONTROL: return NumValueInput;
+  default:
+    assert(UseKind == Use::K_EFFECT && "Invalid Use Kind");
+    return NumValueInput + NumControlInput;
+  }
+}
+
+unsigned& Node::inputCount(Use::Kind UseKind) {
+  switch(UseKind) {
+  case Use::K_VALUE: return NumValueInput;
+  case Use::K_CONTROL: return NumControlInput;
+  default:
+    assert(UseKind == Use::K_EFFECT && "Invalid Use Kind");
+    return NumEffectInput;
+  }
+}
+
+unsigned& Node::userCount(Use::Kind UseKind) {
+  switch(UseKind) {
+  case Use::K_VALUE: return NumValueUser;
+  case Use::K_CONTROL: return NumControlUser;
+  default:
+    assert(UseKind == Use::K_EFFECT && "Invalid Use Kind");
+    return NumEffectUser;
+  }
+}
+
+void Node::moveUseRecord(unsigned From, unsigned To) {
+  Node* Usr = getUser(From);
+  Users[To] = Users[From];
+  Usr->Inputs[Users[To].Peer].Peer = To;
+}
+
+void Node::bumpMutationEpoch() {
+  if(Owner) ++Owner->MutationEpoch;
+}
+
+void Node::addUse(unsigned InputIdx) {
+  // not linked until inserted into Graph
+  if(!Owner) return;
+  Node* Input = getInput(InputIdx);
+  auto UseKind = inputUseKind(InputIdx);
+  // make room at the end of the partition by moving the
+  // first record of every following partition to its end
+  unsigned Pos = Input->Users.size();
+  Input->Users.push_back(EdgeRecord());
+  for(auto K = Use::K_EFFECT; K > UseKind;
+      K = static_cast<Use::Kind>(K - 1)) {
+    unsigned Begin = Input->userBegin(K);
+    if(Input->userCount(K) && Begin != Pos) {
+      Input->moveUseRecord(Begin, Pos);
+    }
+    Pos = Begin;
+  }
+  Input->Users[Pos] = {getEdge(this), InputIdx};
+  Inputs[InputIdx].Peer = Pos;
+  ++Input->userCount(UseKind);
+  bumpMutationEpoch();
+}
+
+void Node::removeUse(unsigned InputIdx) {
+  if(!Owner) return;
+  Node* Input = getInput(InputIdx);
+  auto UseKind = inputUseKind(InputIdx);
+  unsigned UseIdx = Inputs[InputIdx].Peer;
+  assert(UseIdx < Input->Users.size() && Input->getUser(UseIdx) == this &&
+         "Corrupted use record");
+  // fill the hole with the last record of the partition,
+  // then do the same for every following partition
+  unsigned Hole = UseIdx;
+  for(auto K = UseKind; K <= Use::K_EFFECT;
+      K = static_cast<Use::Kind>(K + 1)) {
+    unsigned Begin = Input->userBegin(K);
+    unsigned Last = Begin + Input->userCount(K) - 1;
+    if(Input->userCount(K) && Last != Hole) {
+      Input->moveUseRecord(Last, Hole);
+    }
+    if(Input->userCount(K)) Hole = Last;
+  }
+  assert(Hole == Input->Users.size() - 1);
+  Input->Users.pop_back();
+  --Input->userCount(UseKind);
+  if(Owner->GarbageCandidates)
+    Owner->GarbageCandidates->push_back(Input);
+  bumpMutationEpoch();
+}
+
+void Node::updateUseIndices(unsigned InputIdx) {
+  if(!Owner) return;
+  for(auto i = InputIdx, N = unsigned(Inputs.size()); i < N; ++i)
+    getInput(i)->Users[Inputs[i].Peer].Peer = i;
+}
+
+void Node::transferUsers(Node* To, Use::Kind UseKind) {
+  assert(To != this);
+  constexpr auto NumKinds = 3U;
+  auto isMoved = [UseKind](Use::Kind K) {
+    return UseKind == Use::K_NONE || UseKind == K;
+  };
+  // partitions of To before and after the transfer
+  unsigned OldBegin[NumKinds], NewBegin[NumKinds], NumMoved[NumKinds];
+  unsigned TotalMoved = 0U;
+  for(auto i = 0U; i < NumKinds; ++i) {
+    auto K = static_cast<Use::Kind>(Use::K_VALUE + i);
+    OldBegin[i] = To->userBegin(K);
+    NewBegin[i] = OldBegin[i] + TotalMoved;
+    NumMoved[i] = isMoved(K)? userCount(K) : 0U;
+    TotalMoved += NumMoved[i];
+  }
+  if(!TotalMoved) return;
+
+  // shift the following partitions of To to make room,
+  // starting from the last record so nothing is overwritten
+  To->Users.resize(To->Users.size() + TotalMoved);
+  for(auto i = NumKinds; i-- > 1U;) {
+    if(NewBegin[i] == OldBegin[i]) continue;
+    auto K = static_cast<Use::Kind>(Use::K_VALUE + i);
+    for(auto j = To->userCount(K); j-- > 0U;)
+      To->moveUseRecord(OldBegin[i] + j, NewBegin[i] + j);
+  }
+
+  // append the records and point the users to To
+  for(auto i = 0U; i < NumKinds; ++i) {
+    if(!NumMoved[i]) continue;
+    auto K = static_cast<Use::Kind>(Use::K_VALUE + i);
+    unsigned Src = userBegin(K);
+    unsigned Dst = NewBegin[i] + To->userCount(K);
+    for(auto j = 0U; j < NumMoved[i]; ++j, ++Src, ++Dst) {
+      Node* Usr = getUser(Src);
+      unsigned Slot = Users[Src].Peer;
+      To->Users[Dst] = Users[Src];
+      Usr->Inputs[Slot] = {getEdge(To), Dst};
+      if(Owner) Owner->journal(Graph::JournalEntry::SetInput, Usr, this, Slot);
+    }
+    To->userCount(K) += NumMoved[i];
+  }
+
+  // close the gaps left in our own partitions
+  unsigned Dst = 0U;
+  for(auto i = 0U; i < NumKinds; ++i) {
+    auto K = static_cast<Use::Kind>(Use::K_VALUE + i);
+    if(NumMoved[i]) {
+      userCount(K) = 0U;
+      continue;
+    }
+    for(auto Src = userBegin(K), E = Src + userCount(K); Src < E;)
+      moveUseRecord(Src++, Dst++);
+  }
+  Users.resize(Dst);
+  if(Owner && Owner->GarbageCandidates)
+    Owner->GarbageCandidates->push_back(this);
+  bumpMutationEpoch();
+}
+
+void Node::insertNodeInput(Use::Kind UseKind, unsigned Index,
                            Node* NewNode) {
-  auto It = Inputs.begin();
-  std::advance(It, Size + Offset);
-  Inputs.insert(It, NewNode);
+  unsigned& Size = inputCount(UseKind);
+  assert(Index <= Size);
+  unsigned Idx = Index + inputBegin(UseKind);
+  if(Owner)
+    Owner->journal(Graph::JournalEntry::InsertInput, this, nullptr, Idx,
+                   UseKind);
+  Inputs.insert(Inputs.begin() + Idx, EdgeRecord{getEdge(NewNode), 0U});
   Size += 1;
-  NewNode->Users.push_back(this);
+  // fix the shifted slots first, addUse might move their records
+  updateUseIndices(Idx + 1);
+  addUse(Idx);
 }
 
 void Node::setNodeInput(unsigned Index, unsigned Size, unsigned Offset,
@@ -40,20 +229,12 @@ void Node::setNodeInput(unsigned Index, unsigned Size, unsigned Offset,
   Index += Offset;
   Size += Offset;
   assert(Index < Size);
-  Node* OldNode = Inputs[Index];
-  auto It = std::find(OldNode->Users.begin(), OldNode->Users.end(),
-                      this);
-  assert(It != OldNode->Users.end());
-  OldNode->Users.erase(It);
-  Inputs[Index] = NewNode;
-  NewNode->Users.push_back(this);
-}
-
-void Node::cleanupRemoveNodeInput(Node* OldInput) {
-  auto It = std::find(OldInput->Users.begin(), OldInput->Users.end(),
-                      this);
-  assert(It != OldInput->Users.end());
-  OldInput->Users.erase(It);
+  if(Owner)
+    Owner->journal(Graph::JournalEntry::SetInput, this, getInput(Index),
+                   Index);
+  removeUse(Index);
+  Inputs[Index].Target = getEdge(NewNode);
+  addUse(Index);
 }
 
 void Node::removeNodeInput(unsigned Index, unsigned& Size, unsigned Offset) {
@@ -61,32 +242,42 @@ void Node::removeNodeInput(unsigned Index, unsigned& Size, unsigned Offset) {
   Index += Offset;
   S += Offset;
   assert(Index < S);
-  Node* OldNode = Inputs[Index];
-  cleanupRemoveNodeInput(OldNode);
+  if(Owner)
+    Owner->journal(Graph::JournalEntry::EraseInput, this, getInput(Index),
+                   Index, inputUseKind(Index));
+  removeUse(Index);
   Inputs.erase(Inputs.begin() + Index);
   Size -= 1;
+  updateUseIndices(Index);
 }
 
 void Node::removeNodeInputAll(Node* Target, unsigned& Size, unsigned Offset) {
-  auto I = Inputs.begin() + Offset;
-  while(I != (Inputs.begin() + Size + Offset)) {
-    auto* N = *I;
-    if(N == Target) {
-      // remove
-      cleanupRemoveNodeInput(N);
-      I = Inputs.erase(I);
-      --Size;
-    } else {
-      ++I;
+  // compact the remaining inputs in one pass
+  unsigned Dst = Offset;
+  for(auto Src = Offset, E = Offset + Size; Src < E; ++Src) {
+    if(getInput(Src) == Target) {
+      // as if they're erased one by one
+      if(Owner)
+        Owner->journal(Graph::JournalEntry::EraseInput, this, Target,
+                       Dst, inputUseKind(Src));
+      removeUse(Src);
+      continue;
     }
+    Inputs[Dst] = Inputs[Src];
+    ++Dst;
   }
+  unsigned NumRemoved = Offset + Size - Dst;
+  if(!NumRemoved) return;
+  Inputs.erase(Inputs.begin() + Dst, Inputs.begin() + Dst + NumRemoved);
+  Size -= NumRemoved;
+  updateUseIndices(Offset);
 }
 
 void Node::setValueInput(unsigned Index, Node* NewNode) {
   setNodeInput(Index, NumValueInput, 0, NewNode);
 }
 void Node::appendValueInput(Node* NewNode) {
-  appendNodeInput(NumValueInput, 0, NewNode);
+  insertNodeInput(Use::K_VALUE, NumValueInput, NewNode);
 }
 void Node::removeValueInput(unsigned Index) {
   removeNodeInput(Index, NumValueInput, 0);
@@ -99,7 +290,7 @@ void Node::setControlInput(unsigned Index, Node* NewNode) {
   setNodeInput(Index, NumControlInput, NumValueInput, NewNode);
 }
 void Node::appendControlInput(Node* NewNode) {
-  appendNodeInput(NumControlInput, NumValueInput, NewNode);
+  insertNodeInput(Use::K_CONTROL, NumControlInput, NewNode);
 }
 void Node::removeControlInput(unsigned Index) {
   removeNodeInput(Index, NumControlInput, NumValueInput);
@@ -112,8 +303,7 @@ void Node::setEffectInput(unsigned Index, Node* NewNode) {
   setNodeInput(Index, NumEffectInput, NumValueInput + NumControlInput, NewNode);
 }
 void Node::appendEffectInput(Node* NewNode) {
-  appendNodeInput(NumEffectInput, NumValueInput + NumControlInput,
-                  NewNode);
+  insertNodeInput(Use::K_EFFECT, NumEffectInput, NewNode);
 }
 void Node::removeEffectInput(unsigned Index) {
   removeNodeInput(Index, NumEffectInput, NumValueInput + NumControlInput);
@@ -132,35 +322,13 @@ void Node::Kill(Node* DeadNode) {
     setEffectInput(i, DeadNode);
 
   // replace all uses with Dead node
-  ReplaceWith(DeadNode, Use::K_VALUE);
-  ReplaceWith(DeadNode, Use::K_CONTROL);
-  ReplaceWith(DeadNode, Use::K_EFFECT);
+  ReplaceWith(DeadNode);
 
+  if(!IsKilled && Owner)
+    Owner->onNodeKilled(this);
   IsKilled = true;
 }
 
-llvm::iterator_range<Node::value_user_iterator>
-Node::value_users() {
-  is_value_use Pred(this);
-  value_user_iterator it_begin(Pred, Users.begin(), Users.end()),
-                      it_end(Pred, Users.end(), Users.end());
-  return llvm::make_range(it_begin, it_end);
-}
-llvm::iterator_range<Node::control_user_iterator>
-Node::control_users() {
-  is_control_use Pred(this);
-  control_user_iterator it_begin(Pred, Users.begin(), Users.end()),
-                        it_end(Pred, Users.end(), Users.end());
-  return llvm::make_range(it_begin, it_end);
-}
-llvm::iterator_range<Node::effect_user_iterator>
-Node::effect_users() {
-  is_effect_use Pred(this);
-  effect_user_iterator it_begin(Pred, Users.begin(), Users.end()),
-                       it_end(Pred, Users.end(), Users.end());
-  return llvm::make_range(it_begin, it_end);
-}
-
 bool Node::ReplaceUseOfWith(Node* From, Node* To, Use::Kind UseKind) {
   switch(UseKind) {
   case Use::K_NONE:
@@ -192,30 +360,7 @@ bool Node::ReplaceUseOfWith(Node* From, Node* To, Use::Kind UseKind) {
 }
 
 void Node::ReplaceWith(Node* Replacement, Use::Kind UseKind) {
-  switch(UseKind) {
-  case Use::K_NONE:
-    // replace every category of uses
-    ReplaceWith(Replacement, Use::K_VALUE);
-    ReplaceWith(Replacement, Use::K_CONTROL);
-    ReplaceWith(Replacement, Use::K_EFFECT);
-    break;
-  case Use::K_VALUE: {
-    std::vector<Node*> Usrs(value_users().begin(), value_users().end());
-    for(Node* Usr : Usrs)
-      Usr->ReplaceUseOfWith(this, Replacement, UseKind);
-    break;
-  }
-  case Use::K_CONTROL: {
-    std::vector<Node*> Usrs(control_users().begin(), control_users().end());
-    for(Node* Usr : Usrs)
-      Usr->ReplaceUseOfWith(this, Replacement, UseKind);
-    break;
-  }
-  case Use::K_EFFECT: {
-    std::vector<Node*> Usrs(effect_users().begin(), effect_users().end());
-    for(Node* Usr : Usrs)
-      Usr->ReplaceUseOfWith(this, Replacement, UseKind);
-    break;
-  }
-  }
+  // K_NONE replaces every category of uses
+  if(Replacement == this) return;
+  transferUsers(Replacement, UseKind);
 }
@@ -3,23 +3,38 @@
 
 using namespace graphir;
 
-NodeMarkerBase::NodeMarkerBase(Graph& G, unsigned NumState)
-  : MarkerMin(G.MarkerMax), MarkerMax(G.MarkerMax += NumState){
+NodeMarkerBase::NodeMarkerBase(Graph& graph, unsigned NumStates)
+  : G(graph), Slot(G.AcquireMarkerSlot()), Epoch(0U),
+    NumState(NumStates) {
   assert(NumState != 0U);
-  assert(MarkerMin < MarkerMax && "Wraparound!");
+  if(Slot < Node::NumMarkerSlots)
+    Epoch = G.MarkerSlots[Slot].LastEpoch;
+  else
+    Overflow.reset(new NodeMap<MarkerTy>());
+}
+
+NodeMarkerBase::~NodeMarkerBase() {
+  if(!Overflow)
+    G.ReleaseMarkerSlot(Slot);
 }
 
 NodeMarkerBase::MarkerTy
 NodeMarkerBase::Get(Node* N) {
-  auto Data = N->MarkerData;
-  if(Data < MarkerMin) return 0;
-  assert(Data < MarkerMax &&
-         "Using an old NodeMarker?");
-  return Data - MarkerMin;
+  if(Overflow) {
+    auto It = Overflow->find(N);
+    return It != Overflow->end()? It->second : 0U;
+  }
+  const auto& Data = N->Markers[Slot];
+  return Data.Epoch == Epoch? Data.Data : 0U;
 }
 
 void NodeMarkerBase::Set(Node* N, NodeMarkerBase::MarkerTy NewMarker) {
-  assert(NewMarker < (MarkerMax - MarkerMin));
-  assert(N->MarkerData < MarkerMax);
-  N->MarkerData = (MarkerMin + NewMarker);
+  assert(NewMarker < NumState);
+  if(Overflow) {
+    (*Overflow)[N] = NewMarker;
+    return;
+  }
+  auto& Data = N->Markers[Slot];
+  Data.Epoch = Epoch;
+  Data.Data = NewMarker;
 }
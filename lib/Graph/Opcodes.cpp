@@ -15,13 +15,13 @@ std::ostream& IrOpcode::Print(const Graph& G, std::ostream& OS, Node* N) {
   CASE(Dead, STR(Dead))
   case IrOpcode::ConstantInt: {
     OS << "ConstInt<"
-       << NodeProperties<IrOpcode::ConstantInt>(N).as<int32_t>(G)
+       << NodeProperties<IrOpcode::ConstantInt>(N).as<int32_t>()
        << ">";
     break;
   }
   case IrOpcode::ConstantStr: {
     OS << "ConstStr<"
-       << NodeProperties<IrOpcode::ConstantStr>(N).str(G)
+       << NodeProperties<IrOpcode::ConstantStr>(N).str()
        << ">";
     break;
   }
@@ -30,7 +30,7 @@ std::ostream& IrOpcode::Print(const Graph& G, std::ostream& OS, Node* N) {
                       .getFunctionStart(G);
     std::string Name = "N/A";
     if(FuncStart)
-      Name = NodeProperties<IrOpcode::Start>(FuncStart).name(G);
+      Name = NodeProperties<IrOpcode::Start>(FuncStart).name();
     OS << "FunctionStub<" << Name << ">";
     break;
   }
@@ -42,7 +42,7 @@ std::ostream& IrOpcode::Print(const Graph& G, std::ostream& OS, Node* N) {
                       .getFunctionStart(G);
     std::string Name = "N/A";
     if(FuncStart)
-      Name = NodeProperties<IrOpcode::Start>(FuncStart).name(G);
+      Name = NodeProperties<IrOpcode::Start>(FuncStart).name();
     OS << "Call<" << Name << ">";
     break;
   }
@@ -79,3 +79,32 @@ std::ostream& IrOpcode::Print(const Graph& G, std::ostream& OS, Node* N) {
 #undef CASE
 #undef STR
 }
+
+const char* IrOpcode::GetName(IrOpcode::ID OC) {
+#define STR(V) #V
+#define CASE(OC, S)  \
+  case IrOpcode::OC:  \
+    return S;
+  switch(OC) {
+  CASE(None, STR(None))
+#define COMMON_OP(OC) CASE(OC, STR(OC))
+#define CONST_OP(OC) CASE(OC, STR(OC))
+#define CONTROL_OP(OC) CASE(OC, STR(OC))
+#define MEMORY_OP(OC) CASE(OC, STR(OC))
+#define INTERPROC_OP(OC) CASE(OC, STR(OC))
+#define SRC_OP(OC) CASE(Src##OC, STR(Src##OC))
+#define VIRT_OP(OC) CASE(Virt##OC, STR(Virt##OC))
+#include "graphir/Graph/Opcodes.def"
+#define DLX_ARITH_OP(OC)  \
+  CASE(DLX##OC, STR(DLX##OC))  \
+  CASE(DLX##OC##I, STR(DLX##OC##I))
+#define DLX_COMMON(OC) CASE(DLX##OC, STR(DLX##OC))
+#define DLX_CONST(OC) DLX_COMMON(OC)
+#define VIRT_OP(OC) CASE(Virt##OC, STR(Virt##OC))
+#include "graphir/Graph/DLXOpcodes.def"
+  default:
+    return "Unknown";
+  }
+#undef CASE
+#undef STR
+}
@@ -0,0 +1,71 @@
+#include "graphir/Graph/ReducerStats.h"
+
+using namespace graphir;
+
+ReducerStats::Counters&
+ReducerStats::Counters::operator+=(const Counters& Other) {
+  NumVisits += Other.NumVisits;
+  NumReduces += Other.NumReduces;
+  NumReplacements += Other.NumReplacements;
+  NumInPlaceChanges += Other.NumInPlaceChanges;
+  NumRevisits += Other.NumRevisits;
+  ReduceTime += Other.ReduceTime;
+  return *this;
+}
+
+ReducerStats::Counters ReducerStats::Entry::total() const {
+  Counters Sum;
+  for(auto& C : PerOpcode)
+    Sum += C;
+  return Sum;
+}
+
+ReducerStats& ReducerStats::Get() {
+  static ReducerStats Stats;
+  return Stats;
+}
+
+const ReducerStats::Entry*
+ReducerStats::lookup(const std::string& ReducerName) const {
+  auto It = Entries.find(ReducerName);
+  return It != Entries.end()? &It->second : nullptr;
+}
+
+static void dumpCounters(std::ostream& OS, const ReducerStats::Counters& C) {
+  OS << "\"visits\": " << C.NumVisits
+     << ", \"reduce_calls\": " << C.NumReduces
+     << ", \"replacements\": " << C.NumReplacements
+     << ", \"in_place_changes\": " << C.NumInPlaceChanges
+     << ", \"revisits\": " << C.NumRevisits
+     << ", \"reduce_time_ms\": " << C.ReduceTime;
+}
+
+void ReducerStats::dumpJSON(std::ostream& OS) const {
+  // reducer and opcode names are plain identifiers,
+  // so nothing needs to be escaped
+  OS << "{";
+  bool FirstReducer = true;
+  for(auto& KV : Entries) {
+    auto& E = KV.second;
+    OS << (FirstReducer? "\n" : ",\n")
+       << "  \"" << KV.first << "\": {\n"
+       << "    \"runs\": " << E.NumRuns
+       << ", \"wall_time_ms\": " << E.WallTime
+       << ", \"max_worklist\": " << E.MaxWorklistSize << ",\n    ";
+    dumpCounters(OS, E.total());
+    OS << ",\n    \"opcodes\": {";
+    bool FirstOpcode = true;
+    for(unsigned OC = 0U; OC < IrOpcode::NumOpcodes; ++OC) {
+      auto& C = E.PerOpcode[OC];
+      if(!C.NumVisits && !C.NumReduces && !C.NumRevisits) continue;
+      OS << (FirstOpcode? "\n" : ",\n")
+         << "      \"" << IrOpcode::GetName(IrOpcode::ID(OC)) << "\": {";
+      dumpCounters(OS, C);
+      OS << "}";
+      FirstOpcode = false;
+    }
+    OS << (FirstOpcode? "}" : "\n    }") << "\n  }";
+    FirstReducer = false;
+  }
+  OS << (FirstReducer? "}" : "\n}") << "\n";
+}
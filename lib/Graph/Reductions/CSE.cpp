@@ -44,9 +44,8 @@ CSEReducer::CSEReducer(GraphEditor::Interface* editor)
   : GraphEditor(editor),
     G(Editor->GetGraph()) {}
 
-void CSEReducer::RevisitNodes(unsigned OC, Node* Except) {
-  auto& Nodes = NodeOpMap[OC];
-  for(auto* N : Nodes) {
+void CSEReducer::RevisitNodes(IrOpcode::ID OC, Node* Except) {
+  for(auto* N : G.nodes_of(OC)) {
     if(N == Except) continue;
     Revisit(N);
   }
@@ -57,16 +56,12 @@ GraphReduction CSEReducer::ReduceArithmetic(Node* N) {
      N->getNumControlInput())
     return NoChange();
 
-  auto OC = static_cast<unsigned>(N->getOp());
-  if(!NodeOpMap[OC].count(N))
-    NodeOpMap[OC].insert(N);
-
+  auto OC = N->getOp();
   auto NewHash = GetNodeHash(N);
   if(auto* NewNode = NodeHashMap.find_node(NewHash)) {
     if(NewNode != N) {
       // replace with new node
       NodeHashMap.erase(N);
-      NodeOpMap[OC].erase(N);
       RevisitNodes(OC, N);
       return Replace(NewNode);
     }
@@ -97,21 +97,23 @@ Node* DLXMemoryLegalize::MergeAllocas(const std::set<Node*>& Allocas) {
 
 void DLXMemoryLegalize::RunOnFunction(SubGraph& SG) {
   std::set<Node*> LocalAllocas;
-  for(auto* N : SG.nodes()) {
-    if(N->getOp() == IrOpcode::Alloca &&
-       !G.IsGlobalVar(N))
+  for(auto* N : SG.nodes_of(IrOpcode::Alloca)) {
+    if(!G.IsGlobalVar(N))
       LocalAllocas.insert(N);
   }
   (void) MergeAllocas(LocalAllocas);
 }
 
 void DLXMemoryLegalize::Run() {
+  auto* PrevFunc = G.getValueNumberingFunction();
   // local allocas
   for(auto& SG : G.subregions()) {
+    G.SetValueNumberingFunction(SG.getTailNode());
     RunOnFunction(SG);
   }
 
   // global allocas
+  G.SetValueNumberingFunction(nullptr);
   std::set<Node*> GlobalAllocas(G.global_var_begin(),
                                 G.global_var_end());
   auto* NewGV = MergeAllocas(GlobalAllocas);
@@ -119,4 +121,5 @@ void DLXMemoryLegalize::Run() {
   for(auto* GA: GlobalAllocas) {
     G.ReplaceGlobalVar(GA, NewGV);
   }
+  G.SetValueNumberingFunction(PrevFunc);
 }
@@ -17,30 +17,30 @@ GraphReduction PeepholeReducer::ReduceArithmetic(Node* N) {
                                           RNP(NP.RHS());
     switch(N->getOp()) {
     case IrOpcode::BinAdd: {
-      auto LHSVal = LNP.as<int32_t>(G),
-           RHSVal = RNP.as<int32_t>(G);
+      auto LHSVal = LNP.as<int32_t>(),
+           RHSVal = RNP.as<int32_t>();
       auto* NewNode
         = NodeBuilder<IrOpcode::ConstantInt>(&G, LHSVal + RHSVal).Build();
       return Replace(NewNode);
     }
     case IrOpcode::BinSub: {
-      auto LHSVal = LNP.as<int32_t>(G),
-           RHSVal = RNP.as<int32_t>(G);
+      auto LHSVal = LNP.as<int32_t>(),
+           RHSVal = RNP.as<int32_t>();
       auto* NewNode
         = NodeBuilder<IrOpcode::ConstantInt>(&G, LHSVal - RHSVal).Build();
       return Replace(NewNode);
     }
     case IrOpcode::BinMul: {
-      auto LHSVal = LNP.as<int32_t>(G),
-           RHSVal = RNP.as<int32_t>(G);
+      auto LHSVal = LNP.as<int32_t>(),
+           RHSVal = RNP.as<int32_t>();
       auto* NewNode
         = NodeBuilder<IrOpcode::ConstantInt>(&G, LHSVal * RHSVal).Build();
       return Replace(NewNode);
     }
     case IrOpcode::BinDiv: {
       // integer divistion
-      auto LHSVal = LNP.as<int32_t>(G),
-           RHSVal = RNP.as<int32_t>(G);
+      auto LHSVal = LNP.as<int32_t>(),
+           RHSVal = RNP.as<int32_t>();
       auto* NewNode
         = NodeBuilder<IrOpcode::ConstantInt>(&G, LHSVal / RHSVal).Build();
       return Replace(NewNode);
@@ -62,8 +62,8 @@ GraphReduction PeepholeReducer::ReduceRelation(Node* N) {
                                           RNP(NP.RHS());
 #define REL_CASE(OC, Op)  \
   case IrOpcode::OC: {  \
-    auto LHSVal = LNP.as<int32_t>(G), \
-         RHSVal = RNP.as<int32_t>(G); \
+    auto LHSVal = LNP.as<int32_t>(), \
+         RHSVal = RNP.as<int32_t>(); \
     auto* NewNode \
       = NodeBuilder<IrOpcode::ConstantInt>(&G,  \
                                            LHSVal Op RHSVal? 1 : 0) \
@@ -83,7 +83,7 @@ GraphReduction PeepholeReducer::ReduceRelation(Node* N) {
 #undef REL_CASE
   } else if(NP.RHS()->getOp() != IrOpcode::ConstantInt ||
             NodeProperties<IrOpcode::ConstantInt>(NP.RHS())
-            .as<int32_t>(G) != 0) {
+            .as<int32_t>() != 0) {
     // always put zero at RHS
     auto* OldLHS = NP.LHS();
     auto* OldRHS = NP.RHS();
@@ -86,7 +86,7 @@ TEST(CodeGenUnitTest, PreLoweringArithmeticOps) {
     auto* ImmOffset = NodeProperties<IrOpcode::VirtDLXBinOps>(RetVal)
                       .ImmRHS();
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(ImmOffset)
-              .as<int32_t>(G), 4);
+              .as<int32_t>(), 4);
   }
 }
 
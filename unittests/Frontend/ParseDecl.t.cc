@@ -46,7 +46,7 @@ TEST(ParserUnitTest, TestVarDecl) {
     ASSERT_EQ(NP.dim_size(), 1);
     auto* Dim0 = NP.dim(0);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Dim0)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
   }
   SS.clear();
   {
@@ -66,9 +66,9 @@ TEST(ParserUnitTest, TestVarDecl) {
     Node *Dim0 = NP.dim(0),
          *Dim1 = NP.dim(1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Dim0)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Dim1)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
 }
 
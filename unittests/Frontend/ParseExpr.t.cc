@@ -22,9 +22,9 @@ TEST(ParserUnitTest, TestSimpleTerm) {
     Node *LHS = TermNode->getValueInput(0),
          *RHS = TermNode->getValueInput(1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
   SS.clear();
   {
@@ -41,23 +41,23 @@ TEST(ParserUnitTest, TestSimpleTerm) {
     LHS = TermNode->getValueInput(0); // SubTree
     RHS = TermNode->getValueInput(1); // 7
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 7);
+              .as<int32_t>(), 7);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinDiv>(LHS));
     TermNode = LHS;
     // SubTree - / - 43
     LHS = TermNode->getValueInput(0); // SubTree
     RHS = TermNode->getValueInput(1); // 43
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 43);
+              .as<int32_t>(), 43);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinMul>(LHS));
     TermNode = LHS;
     // 94 - * - 87
     LHS = TermNode->getValueInput(0); // 94
     RHS = TermNode->getValueInput(1); // 87
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
 }
 
@@ -75,9 +75,9 @@ TEST(ParserUnitTest, TestSimpleExpr) {
     Node *LHS = ExprNode->getValueInput(0),
          *RHS = ExprNode->getValueInput(1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
   SS.clear();
   {
@@ -94,23 +94,23 @@ TEST(ParserUnitTest, TestSimpleExpr) {
     LHS = ExprNode->getValueInput(0); // SubTree
     RHS = ExprNode->getValueInput(1); // 7
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 7);
+              .as<int32_t>(), 7);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinSub>(LHS));
     ExprNode = LHS;
     // SubTree - (-) - 43
     LHS = ExprNode->getValueInput(0); // SubTree
     RHS = ExprNode->getValueInput(1); // 43
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 43);
+              .as<int32_t>(), 43);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinAdd>(LHS));
     ExprNode = LHS;
     // 94 - + - 87
     LHS = ExprNode->getValueInput(0); // 94
     RHS = ExprNode->getValueInput(1); // 87
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
   SS.clear();
   {
@@ -127,23 +127,23 @@ TEST(ParserUnitTest, TestSimpleExpr) {
     LHS = ExprNode->getValueInput(0); // SubTree
     RHS = ExprNode->getValueInput(1); // 7
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 7);
+              .as<int32_t>(), 7);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinAdd>(LHS));
     ExprNode = LHS;
     // 94 - + - SubTree
     LHS = ExprNode->getValueInput(0); // 94
     RHS = ExprNode->getValueInput(1); // SubTree
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinMul>(RHS));
     ExprNode = RHS;
     // 87 - * - 43
     LHS = ExprNode->getValueInput(0); // 87
     RHS = ExprNode->getValueInput(1); // 43
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 43);
+              .as<int32_t>(), 43);
   }
   SS.clear();
   {
@@ -164,40 +164,40 @@ TEST(ParserUnitTest, TestSimpleExpr) {
     // 9 - / - 2
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(
                 ExprNode->getValueInput(0)
-              ).as<int32_t>(G), 9);
+              ).as<int32_t>(), 9);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(
                 ExprNode->getValueInput(1)
-              ).as<int32_t>(G), 2);
+              ).as<int32_t>(), 2);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinAdd>(LHS));
     ExprNode = LHS;
     // SubTree - + - 5
     LHS = ExprNode->getValueInput(0); // SubTree
     RHS = ExprNode->getValueInput(1); // 5
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 5);
+              .as<int32_t>(), 5);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinAdd>(LHS));
     ExprNode = LHS;
     // 94 - + - SubTree
     LHS = ExprNode->getValueInput(0); // 94
     RHS = ExprNode->getValueInput(1); // SubTree
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinMul>(RHS));
     ExprNode = RHS;
     // 87 - * - SubTree
     LHS = ExprNode->getValueInput(0); // 87
     RHS = ExprNode->getValueInput(1); // SubTree
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
     ASSERT_TRUE(NodeProperties<IrOpcode::BinSub>(RHS));
     ExprNode = RHS;
     // 43 - (-) - 7
     LHS = ExprNode->getValueInput(0); // 43
     RHS = ExprNode->getValueInput(1); // 7
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 43);
+              .as<int32_t>(), 43);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 7);
+              .as<int32_t>(), 7);
   }
 }
 
@@ -214,9 +214,9 @@ TEST(ParserUnitTest, TestRelation) {
     Node *LHS = RelNode->getValueInput(0),
          *RHS = RelNode->getValueInput(1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
   SS.clear();
   {
@@ -229,9 +229,9 @@ TEST(ParserUnitTest, TestRelation) {
     Node *LHS = RelNode->getValueInput(0),
          *RHS = RelNode->getValueInput(1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(LHS)
-              .as<int32_t>(G), 94);
+              .as<int32_t>(), 94);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(RHS)
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
   }
   SS.clear();
   {
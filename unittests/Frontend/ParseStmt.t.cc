@@ -26,7 +26,7 @@ TEST(ParserUnitTest, TestAssignment) {
     NodeProperties<IrOpcode::SrcAssignStmt> NPA(Assign);
     ASSERT_TRUE(NPA);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(NPA.source())
-              .as<int32_t>(G), 2);
+              .as<int32_t>(), 2);
     EXPECT_TRUE(NodeProperties<IrOpcode::SrcVarAccess>(NPA.dest()));
   }
   SS.clear();
@@ -48,7 +48,7 @@ TEST(ParserUnitTest, TestAssignment) {
     NodeProperties<IrOpcode::SrcAssignStmt> NPA2(Assign2);
     ASSERT_TRUE(NPA2);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(NPA2.source())
-              .as<int32_t>(G), 87);
+              .as<int32_t>(), 87);
     auto* Access2 = NPA2.dest();
     NodeProperties<IrOpcode::SrcVarAccess> NPAC2(Access2);
     ASSERT_TRUE(NPAC2);
@@ -70,7 +70,7 @@ TEST(ParserUnitTest, TestAssignment) {
     NodeProperties<IrOpcode::SrcAssignStmt> NPA(Assign);
     ASSERT_TRUE(NPA);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(NPA.source())
-              .as<int32_t>(G), 2);
+              .as<int32_t>(), 2);
 
     NodeProperties<IrOpcode::SrcArrayAccess> NPAC(NPA.dest());
     ASSERT_TRUE(NPAC);
@@ -78,9 +78,9 @@ TEST(ParserUnitTest, TestAssignment) {
     Node *Dim0 = NPAC.dim(0),
          *Dim1 = NPAC.dim(1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Dim0)
-              .as<int32_t>(G), 1);
+              .as<int32_t>(), 1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Dim1)
-              .as<int32_t>(G), 5);
+              .as<int32_t>(), 5);
   }
   SS.clear();
   {
@@ -98,13 +98,13 @@ TEST(ParserUnitTest, TestAssignment) {
     NodeProperties<IrOpcode::SrcAssignStmt> NPA1(Assign1);
     ASSERT_TRUE(NPA1);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(NPA1.source())
-              .as<int32_t>(G), 20);
+              .as<int32_t>(), 20);
 
     Node* Assign2 = P.ParseAssignment();
     NodeProperties<IrOpcode::SrcAssignStmt> NPA2(Assign2);
     ASSERT_TRUE(NPA2);
     EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(NPA2.source())
-              .as<int32_t>(G), 50);
+              .as<int32_t>(), 50);
 
     auto* Access2 = NPA2.dest();
     NodeProperties<IrOpcode::SrcArrayAccess> NPAC2(Access2);
@@ -3,9 +3,12 @@
 #include <gtest/gtest.h>
 
 #include <boost/concept/assert.hpp>
+#include <boost/graph/depth_first_search.hpp>
 #include <boost/graph/graph_concepts.hpp>
+#include <boost/graph/strong_components.hpp>
 
 #include "graphir/Graph/Graph.h"
+#include <vector>
 
 TEST(GraphBGLUnitTest, TestGraphConcept) {
   BOOST_CONCEPT_ASSERT((boost::GraphConcept<graphir::Graph>));
@@ -45,4 +48,81 @@ TEST(SubGraphBGLUnitTest, TestVertexReadablePropertyMapConcept) {
       (boost::ReadablePropertyMapConcept<
           graphir::graph_id_map<graphir::SubGraph, boost::vertex_index_t>,
           graphir::Node*>));
-}
\ No newline at end of file
+}
+TEST(SubGraphBGLUnitTest, TestDenseVertexMaps) {
+  BOOST_CONCEPT_ASSERT(
+      (boost::LvaluePropertyMapConcept<graphir::NodeColorMap,
+                                       graphir::Node*>));
+
+  using namespace graphir;
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const2).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+  // not in the SubGraph
+  (void) NodeBuilder<IrOpcode::ConstantInt>(&G, 3).Build();
+  SubGraph SG(Ret);
+
+  // indices are the positions in the node list
+  auto IndexMap = boost::get(boost::vertex_index, SG);
+  size_t Idx = 0U;
+  for(auto* N : SG.nodes())
+    EXPECT_EQ(boost::get(IndexMap, N), Idx++);
+  EXPECT_EQ(Idx, 4U);
+
+  NodeColorMap ColorMap(SG);
+  boost::depth_first_search(SG, boost::default_dfs_visitor(), ColorMap);
+  for(auto* N : SG.nodes())
+    EXPECT_EQ(boost::get(ColorMap, N), boost::black_color);
+
+  // BGL algorithms using the default vertex_index map
+  std::vector<size_t> Components(boost::num_vertices(SG));
+  auto NumComponents = boost::strong_components(
+      SG, boost::make_iterator_property_map(Components.begin(), IndexMap));
+  EXPECT_EQ(NumComponents, 4U);
+}
+
+TEST(SubGraphBGLUnitTest, TestSubGraphView) {
+  using namespace graphir;
+  using ViewTy = SubGraphView<BackEdgeReversed>;
+  BOOST_CONCEPT_ASSERT((boost::IncidenceGraphConcept<ViewTy>));
+  BOOST_CONCEPT_ASSERT((boost::VertexListGraphConcept<ViewTy>));
+
+  Graph G;
+  auto* Entry = new (&G) Node(IrOpcode::Start, {}, {}, {});
+  G.InsertNode(Entry);
+  auto* Body = new (&G) Node(IrOpcode::IfTrue, {}, {}, {});
+  G.InsertNode(Body);
+  auto* LoopNode = new (&G) Node(IrOpcode::Loop, {}, {Entry, Body}, {});
+  G.InsertNode(LoopNode);
+  Body->appendControlInput(LoopNode);
+  SubGraph SG(LoopNode);
+  ViewTy SGV(SG);
+
+  // plain SubGraph has the original edges
+  std::vector<Use> Edges;
+  for(auto EP = boost::out_edges(LoopNode, SG); EP.first != EP.second;
+      ++EP.first)
+    Edges.push_back(*EP.first);
+  ASSERT_EQ(Edges.size(), 2U);
+  EXPECT_EQ(Edges[1], Use(LoopNode, Body, Use::K_NONE));
+
+  // back-edge is reversed in the view
+  Edges.clear();
+  for(auto EP = boost::out_edges(LoopNode, SGV); EP.first != EP.second;
+      ++EP.first)
+    Edges.push_back(*EP.first);
+  ASSERT_EQ(Edges.size(), 2U);
+  EXPECT_EQ(Edges[0], Use(LoopNode, Entry, Use::K_NONE));
+  EXPECT_EQ(Edges[1], Use(Body, LoopNode, Use::K_NONE));
+  // other edges are untouched
+  auto EP = boost::out_edges(Body, SGV);
+  EXPECT_EQ(*EP.first, Use(Body, LoopNode, Use::K_NONE));
+
+  NodeColorMap ColorMap(SGV);
+  boost::depth_first_search(SGV, boost::default_dfs_visitor(), ColorMap);
+  for(auto* N : SGV.nodes())
+    EXPECT_EQ(boost::get(ColorMap, N), boost::black_color);
+}
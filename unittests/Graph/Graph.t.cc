@@ -1,7 +1,15 @@
 #include "graphir/Graph/Graph.h"
 #include "graphir/Graph/GraphReducer.h"
+#include "graphir/Graph/NodeMarker.h"
+#include "graphir/Graph/NodeUtils.h"
+#include "graphir/Graph/Reductions/CSE.h"
+#include "graphir/Graph/Reductions/Peephole.h"
 #include "gtest/gtest.h"
+#include <algorithm>
+#include <iterator>
+#include <memory>
 #include <sstream>
+#include <vector>
 
 using namespace graphir;
 
@@ -41,3 +49,1005 @@ TEST(GraphUnitTest, TestGraphReducerConcept) {
 
   GraphReducer::RunWithEditor<DummyAdvanceReducer>(G);
 }
+
+TEST(GraphUnitTest, TestReducerWorklistOrder) {
+  struct TraceReducer {
+    std::vector<Node*>* Trace;
+    explicit TraceReducer(std::vector<Node*>* T) : Trace(T) {}
+
+    GraphReduction Reduce(Node* N) {
+      Trace->push_back(N);
+      return GraphReduction();
+    }
+
+    static constexpr
+    const char* name() { return "trace-reducer"; }
+  };
+
+  for(auto Order : {GraphReducer::WorklistOrder::LIFO,
+                    GraphReducer::WorklistOrder::RPO}) {
+    Graph G;
+    auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+                 .FuncName("func_worklist_order")
+                 .Build();
+    auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+    auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+    auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+                .LHS(Const1).RHS(Const2).Build();
+    auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+                 .LHS(Sum).RHS(Const1).Build();
+    auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Prod).Build();
+    Ret->appendControlInput(Func);
+    auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+                .AddTerminator(Ret)
+                .Build();
+    G.AddSubRegion(SubGraph(End));
+
+    std::vector<Node*> Trace;
+    GraphReducer::Run<TraceReducer>(G, Order, &Trace);
+    // every node is reduced exactly once, after its inputs
+    EXPECT_EQ(Trace.size(), SubGraph(End).node_size());
+    auto Pos = [&](Node* N) {
+      return std::find(Trace.begin(), Trace.end(), N) - Trace.begin();
+    };
+    for(auto* N : Trace) {
+      EXPECT_EQ(std::count(Trace.begin(), Trace.end(), N), 1);
+      for(auto* Input : N->inputs())
+        EXPECT_LT(Pos(Input), Pos(N));
+    }
+  }
+}
+
+TEST(GraphUnitTest, TestReducerOpcodeFilter) {
+  static_assert(IrOpcode::CommonOps.contains(IrOpcode::BinAdd), "");
+  static_assert(!IrOpcode::CommonOps.contains(IrOpcode::Phi), "");
+  static_assert(IrOpcode::DLXOps.contains(IrOpcode::DLXAddI), "");
+  static_assert(IrOpcode::DLXOps.contains(IrOpcode::DLXr31), "");
+  static_assert(!IrOpcode::DLXOps.contains(IrOpcode::VirtDLXOps), "");
+
+  struct AddTraceReducer {
+    std::vector<Node*>* Trace;
+    explicit AddTraceReducer(std::vector<Node*>* T) : Trace(T) {}
+
+    GraphReduction Reduce(Node* N) {
+      Trace->push_back(N);
+      return GraphReduction();
+    }
+
+    static constexpr
+    const char* name() { return "add-trace-reducer"; }
+
+    static constexpr
+    IrOpcode::OpcodeSet opcodes() { return {IrOpcode::BinAdd}; }
+  };
+
+  Graph G;
+  auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_opcode_filter")
+               .AddParameter(Arg)
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Arg).RHS(Const1).Build();
+  auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+               .LHS(Sum).RHS(Sum).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Prod).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+
+  std::vector<Node*> Trace;
+  GraphReducer::Run<AddTraceReducer>(G, &Trace);
+  ASSERT_EQ(Trace.size(), 1U);
+  EXPECT_EQ(Trace.front(), Sum);
+}
+
+TEST(GraphUnitTest, TestReducerStats) {
+  EXPECT_STREQ(IrOpcode::GetName(IrOpcode::BinAdd), "BinAdd");
+  EXPECT_STREQ(IrOpcode::GetName(IrOpcode::SrcVarAccess), "SrcVarAccess");
+  EXPECT_STREQ(IrOpcode::GetName(IrOpcode::DLXAddI), "DLXAddI");
+
+  // replace a + b with a
+  struct AddLHSReducer {
+    GraphReduction Reduce(Node* N) {
+      return GraphReduction(N->getValueInput(0));
+    }
+
+    static constexpr
+    const char* name() { return "add-lhs-reducer"; }
+
+    static constexpr
+    IrOpcode::OpcodeSet opcodes() { return {IrOpcode::BinAdd}; }
+  };
+
+  Graph G;
+  auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_reducer_stats")
+               .AddParameter(Arg)
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Arg).RHS(Const1).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+
+  GraphReducer::ResetStats();
+  GraphReducer::Run<AddLHSReducer>(G);
+  EXPECT_EQ(Ret->getValueInput(0), Arg);
+
+  const auto& Stats = GraphReducer::GetStats();
+  std::stringstream SS;
+  Stats.dumpJSON(SS);
+  if(!ReducerStats::Enabled) {
+    EXPECT_TRUE(Stats.empty());
+    EXPECT_EQ(SS.str(), "{}\n");
+    return;
+  }
+
+  const auto* E = Stats.lookup(AddLHSReducer::name());
+  ASSERT_NE(E, nullptr);
+  EXPECT_EQ(E->NumRuns, 1U);
+  EXPECT_GT(E->MaxWorklistSize, 0U);
+  const auto& AddStats = (*E)[IrOpcode::BinAdd];
+  EXPECT_EQ(AddStats.NumVisits, 1U);
+  EXPECT_EQ(AddStats.NumReduces, 1U);
+  EXPECT_EQ(AddStats.NumReplacements, 1U);
+  EXPECT_EQ(AddStats.NumInPlaceChanges, 0U);
+  // other nodes are visited but filtered out
+  EXPECT_GT((*E)[IrOpcode::Return].NumVisits, 0U);
+  EXPECT_EQ((*E)[IrOpcode::Return].NumReduces, 0U);
+  auto Total = E->total();
+  EXPECT_EQ(Total.NumReduces, 1U);
+  EXPECT_GT(Total.NumVisits, 1U);
+
+  auto JSON = SS.str();
+  EXPECT_NE(JSON.find("\"add-lhs-reducer\": {"), std::string::npos);
+  EXPECT_NE(JSON.find("\"BinAdd\": {\"visits\": 1, \"reduce_calls\": 1"),
+            std::string::npos);
+
+  GraphReducer::ResetStats();
+  EXPECT_EQ(GraphReducer::GetStats().lookup(AddLHSReducer::name()), nullptr);
+}
+
+TEST(GraphUnitTest, TestCompositeReducer) {
+  Graph G;
+  auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_composite_reducer")
+               .AddParameter(Arg)
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Const3 = NodeBuilder<IrOpcode::ConstantInt>(&G, 3).Build();
+  auto* Folded = NodeBuilder<IrOpcode::BinAdd>(&G)
+                 .LHS(Const1).RHS(Const2).Build();
+  // identical after folding
+  auto* Sum1 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Arg).RHS(Folded).Build();
+  auto* Sum2 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Arg).RHS(Const3).Build();
+  auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+               .LHS(Sum1).RHS(Sum2).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Prod).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+
+  // folding and CSE cascade in a single run
+  GraphReducer::RunAll<PeepholeReducer, CSEReducer>(G);
+  EXPECT_EQ(Prod->getValueInput(0), Prod->getValueInput(1));
+  auto* Sum = Prod->getValueInput(0);
+  EXPECT_EQ(Sum->getOp(), IrOpcode::BinAdd);
+  EXPECT_EQ(Sum->getValueInput(0), Arg);
+  EXPECT_EQ(Sum->getValueInput(1), Const3);
+}
+
+TEST(GraphUnitTest, TestTrimSharedConstants) {
+  // functions sharing constants, each with a node not
+  // reachable from the function
+  auto Build = [](Graph& G) {
+    for(auto i = 0U; i < 16U; ++i) {
+      auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+      auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+                   .FuncName("func_trim_shared" + std::to_string(i))
+                   .AddParameter(Arg)
+                   .Build();
+      auto* Const = NodeBuilder<IrOpcode::ConstantInt>(&G, i % 3).Build();
+      auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+                  .LHS(Arg).RHS(Const).Build();
+      (void) NodeBuilder<IrOpcode::BinMul>(&G)
+             .LHS(Sum).RHS(Const).Build();
+      auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+      Ret->appendControlInput(Func);
+      auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+                  .AddTerminator(Ret)
+                  .Build();
+      G.AddSubRegion(SubGraph(End));
+    }
+  };
+
+  Graph G;
+  Build(G);
+  auto NumNodes = G.node_size();
+  GraphReducer::RunWithEditor<PeepholeReducer>(G);
+
+  // the orphan BinMuls are gone, the shared constants are not
+  EXPECT_LT(G.node_size(), NumNodes);
+  auto Muls = G.nodes_of(IrOpcode::BinMul);
+  EXPECT_EQ(Muls.begin(), Muls.end());
+  EXPECT_EQ(G.getNumConstNumber(), 3U);
+}
+
+TEST(GraphUnitTest, TestIncrementalTrim) {
+  struct FoldMulReducer {
+    Graph& G;
+    explicit FoldMulReducer(Graph& graph) : G(graph) {}
+
+    GraphReduction Reduce(Node*) {
+      return GraphReduction(
+        NodeBuilder<IrOpcode::ConstantInt>(&G, 0).Build());
+    }
+
+    static constexpr
+    const char* name() { return "fold-mul-reducer"; }
+
+    static constexpr
+    IrOpcode::OpcodeSet opcodes() { return {IrOpcode::BinMul}; }
+  };
+  struct NopReducer {
+    GraphReduction Reduce(Node*) { return GraphReduction(); }
+
+    static constexpr
+    const char* name() { return "nop-reducer"; }
+  };
+
+  Graph G;
+  auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_incremental_trim")
+               .AddParameter(Arg)
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  // Phi -> Sum -> Phi cycle, which is kept alive by Prod
+  auto* Phi = new (&G) Node(IrOpcode::Phi, {Arg, Arg});
+  G.InsertNode(Phi);
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Phi).RHS(Const1).Build();
+  Phi->setValueInput(1, Sum);
+  auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+               .LHS(Phi).RHS(Arg).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Prod).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+  // unreachable, swept by the first run
+  (void) NodeBuilder<IrOpcode::BinSub>(&G).LHS(Arg).RHS(Arg).Build();
+
+  EXPECT_FALSE(G.IsGarbageFree());
+  GraphReducer::Run<NopReducer>(G);
+  EXPECT_TRUE(G.IsGarbageFree());
+  auto NumNodes = G.node_size();
+  auto Subs = G.nodes_of(IrOpcode::BinSub);
+  EXPECT_EQ(Subs.begin(), Subs.end());
+
+  // folding Prod cuts the cycle loose
+  GraphReducer::SetVerifyTrim(true);
+  GraphReducer::Run<FoldMulReducer>(G, G);
+  GraphReducer::SetVerifyTrim(false);
+  EXPECT_TRUE(G.IsGarbageFree());
+  EXPECT_EQ(G.node_size(), NumNodes - 3U + 1U);
+  auto Phis = G.nodes_of(IrOpcode::Phi);
+  EXPECT_EQ(Phis.begin(), Phis.end());
+  auto Adds = G.nodes_of(IrOpcode::BinAdd);
+  EXPECT_EQ(Adds.begin(), Adds.end());
+  EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Ret->getValueInput(0))
+              .as<int32_t>(), 0);
+
+  // Sum2 is still live through Live, but Diff is left with
+  // no user once Prod2 is folded
+  auto* Sum2 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Arg).RHS(Const1).Build();
+  auto* Diff = NodeBuilder<IrOpcode::BinSub>(&G)
+               .LHS(Sum2).RHS(Arg).Build();
+  auto* Prod2 = NodeBuilder<IrOpcode::BinMul>(&G)
+                .LHS(Diff).RHS(Sum2).Build();
+  auto* Live = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Sum2).RHS(Const1).Build();
+  auto* Total = NodeBuilder<IrOpcode::BinAdd>(&G)
+                .LHS(Prod2).RHS(Live).Build();
+  Ret->setValueInput(0, Total);
+  GraphReducer::Run<NopReducer>(G);
+  EXPECT_TRUE(G.IsGarbageFree());
+  NumNodes = G.node_size();
+
+  GraphReducer::SetVerifyTrim(true);
+  GraphReducer::Run<FoldMulReducer>(G, G);
+  GraphReducer::SetVerifyTrim(false);
+  EXPECT_TRUE(Diff->IsRemoved());
+  EXPECT_FALSE(Sum2->IsRemoved());
+  EXPECT_FALSE(Live->IsRemoved());
+  EXPECT_EQ(Total->getValueInput(1), Live);
+  EXPECT_EQ(G.node_size(), NumNodes - 2U);
+}
+
+TEST(GraphUnitTest, TestNodeUseList) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const1).Build();
+  auto* Mul = NodeBuilder<IrOpcode::BinMul>(&G)
+              .LHS(Const1).RHS(Sum).Build();
+  // one use record per edge
+  EXPECT_EQ(Const1->user_size(), 3);
+  EXPECT_EQ(Sum->user_size(), 1);
+
+  Sum->setValueInput(0, Const2);
+  EXPECT_EQ(Const1->user_size(), 2);
+  EXPECT_EQ(Const2->user_size(), 1);
+  EXPECT_EQ(Sum->getValueInput(0), Const2);
+  EXPECT_EQ(Sum->getValueInput(1), Const1);
+
+  // shifting input slots should keep records in sync
+  Mul->removeValueInput(0);
+  EXPECT_EQ(Const1->user_size(), 1);
+  EXPECT_EQ(Mul->getValueInput(0), Sum);
+  Mul->removeValueInputAll(Sum);
+  EXPECT_EQ(Mul->getNumValueInput(), 0);
+  EXPECT_EQ(Sum->user_size(), 0);
+
+  Const1->ReplaceWith(Const2);
+  EXPECT_EQ(Const1->user_size(), 0);
+  EXPECT_EQ(Const2->user_size(), 2);
+  EXPECT_EQ(Sum->getValueInput(0), Const2);
+  EXPECT_EQ(Sum->getValueInput(1), Const2);
+
+  Sum->Kill(NodeBuilder<IrOpcode::Dead>(&G).Build());
+  EXPECT_EQ(Const2->user_size(), 0);
+  EXPECT_TRUE(Sum->IsDead());
+}
+
+TEST(GraphUnitTest, TestNodeUserPartitions) {
+  Graph G;
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_user_partitions")
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Branch = NodeBuilder<IrOpcode::If>(&G)
+                 .Condition(Const1).Build();
+  Branch->appendControlInput(Func);
+  auto* Merge = NodeBuilder<IrOpcode::Merge>(&G)
+                .AddCtrlInput(Branch).Build();
+  auto* PHINode = NodeBuilder<IrOpcode::Phi>(&G)
+                  .AddValueInput(Branch)
+                  .AddEffectInput(Branch)
+                  .SetCtrlMerge(Merge)
+                  .Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Branch).Build();
+
+  // Branch: value users {PHINode, Ret}, control users {Merge},
+  // effect users {PHINode}
+  EXPECT_EQ(Branch->user_size(), 4);
+  EXPECT_EQ(std::distance(Branch->value_users().begin(),
+                          Branch->value_users().end()), 2);
+  ASSERT_EQ(std::distance(Branch->control_users().begin(),
+                          Branch->control_users().end()), 1);
+  EXPECT_EQ(*Branch->control_users().begin(), Merge);
+  ASSERT_EQ(std::distance(Branch->effect_users().begin(),
+                          Branch->effect_users().end()), 1);
+  EXPECT_EQ(*Branch->effect_users().begin(), PHINode);
+
+  Ret->removeValueInput(0);
+  ASSERT_EQ(std::distance(Branch->value_users().begin(),
+                          Branch->value_users().end()), 1);
+  EXPECT_EQ(*Branch->value_users().begin(), PHINode);
+  EXPECT_EQ(*Branch->control_users().begin(), Merge);
+  EXPECT_EQ(*Branch->effect_users().begin(), PHINode);
+
+  // appending an input shifts the later uses of the same node
+  PHINode->appendValueInput(Branch);
+  EXPECT_EQ(std::distance(Branch->value_users().begin(),
+                          Branch->value_users().end()), 2);
+  EXPECT_EQ(PHINode->getEffectInput(0), Branch);
+
+  // only replace the effect use
+  Branch->ReplaceWith(Func, Use::K_EFFECT);
+  EXPECT_EQ(Branch->effect_users().begin(), Branch->effect_users().end());
+  EXPECT_EQ(PHINode->getEffectInput(0), Func);
+  EXPECT_EQ(PHINode->getValueInput(0), Branch);
+  EXPECT_EQ(PHINode->getValueInput(1), Branch);
+}
+
+TEST(GraphUnitTest, TestNodeMap) {
+  Graph G;
+  std::vector<Node*> Consts;
+  for(auto i = 0; i < 300; ++i)
+    Consts.push_back(NodeBuilder<IrOpcode::ConstantInt>(&G, i).Build());
+  // ids are dense and follow the insertion order
+  for(auto i = 0U; i < Consts.size(); ++i)
+    EXPECT_EQ(Consts[i]->getId(), i);
+  EXPECT_EQ(G.getNumNodeIds(), Consts.size());
+
+  NodeMap<int> Map;
+  auto& First = Map[Consts[0]];
+  First = 87;
+  // growing the map should not invalidate references
+  for(auto i = 1U; i < Consts.size(); i += 2)
+    Map[Consts[i]] = static_cast<int>(i);
+  EXPECT_EQ(First, 87);
+  EXPECT_EQ(Map.size(), 151);
+  EXPECT_EQ(Map.count(Consts[2]), 0);
+  EXPECT_EQ(Map.at(Consts[299]), 299);
+  EXPECT_EQ(Map.find(Consts[4]), Map.end());
+
+  EXPECT_EQ(Map.erase(Consts[1]), 1);
+  EXPECT_EQ(Map.erase(Consts[1]), 0);
+  EXPECT_EQ(Map.size(), 150);
+  // iterate in the order of ids
+  Node* Prev = nullptr;
+  size_t NumVisited = 0U;
+  for(auto& Pair : Map) {
+    if(Prev) {
+      EXPECT_LT(Prev->getId(), Pair.first->getId());
+    }
+    Prev = Pair.first;
+    ++NumVisited;
+  }
+  EXPECT_EQ(NumVisited, Map.size());
+
+  NodeSet Set;
+  EXPECT_TRUE(Set.insert(Consts[200]));
+  EXPECT_FALSE(Set.insert(Consts[200]));
+  EXPECT_TRUE(Set.insert(Consts[3]));
+  EXPECT_EQ(Set.count(Consts[4]), 0);
+  EXPECT_EQ(Set.size(), 2);
+  EXPECT_EQ(*Set.begin(), Consts[3]);
+  EXPECT_EQ(Set.erase(Consts[3]), 1);
+  EXPECT_EQ(*Set.begin(), Consts[200]);
+}
+
+TEST(GraphUnitTest, TestSubGraphNodeCache) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const1).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+
+  SubGraph SG(Ret);
+  ASSERT_EQ(SG.node_size(), 3);
+  std::vector<Node*> Expected{Ret, Sum, Const1};
+  EXPECT_TRUE(std::equal(SG.node_begin(), SG.node_end(), Expected.begin()));
+
+  // list is reused as long as the graph is not changed
+  auto Epoch = G.getMutationEpoch();
+  auto It = SG.node_begin();
+  NodeBuilder<IrOpcode::ConstantInt>(&G, 3).Build();
+  EXPECT_EQ(G.getMutationEpoch(), Epoch);
+  EXPECT_EQ(SG.node_size(), 3);
+
+  Sum->setValueInput(1, Const2);
+  EXPECT_NE(G.getMutationEpoch(), Epoch);
+  ASSERT_EQ(SG.node_size(), 4);
+  EXPECT_EQ(*std::next(SG.node_begin(), 3), Const2);
+  // old iterators still walk through the previous snapshot
+  EXPECT_EQ(std::distance(It, SG.node_end()), 3);
+}
+
+TEST(GraphUnitTest, TestCollectDeadNodes) {
+  Graph G;
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_collect_dead_nodes")
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  // not reachable from the function
+  auto* Garbage1 = NodeBuilder<IrOpcode::BinMul>(&G)
+                   .LHS(Const1).RHS(Const2).Build();
+  auto* Garbage2 = NodeBuilder<IrOpcode::BinSub>(&G)
+                   .LHS(Garbage1).RHS(Const1).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const2).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+  (void) NodeBuilder<IrOpcode::Dead>(&G).Build();
+  auto NumNodes = G.node_size();
+
+  G.MarkNodeDead(Garbage1);
+  G.MarkNodeDead(Garbage2);
+  G.MarkNodeDead(Garbage2);
+  EXPECT_EQ(G.getNumDeadNodes(), 2);
+  // unlinked right away, still in the node list
+  // but skipped by node iterators
+  EXPECT_TRUE(Garbage2->IsRemoved());
+  EXPECT_EQ(Const1->user_size(), 1);
+  EXPECT_EQ(G.node_size(), NumNodes - 2);
+  EXPECT_EQ(std::find(G.node_begin(), G.node_end(), Garbage2), G.node_end());
+  EXPECT_EQ(std::distance(G.node_begin(), G.node_end()), NumNodes - 2);
+
+  EXPECT_EQ(G.CollectDeadNodes(Graph::NodeOrder::RPO), 2);
+  EXPECT_EQ(G.node_size(), NumNodes - 2);
+  EXPECT_EQ(G.getNumDeadNodes(), 0);
+  // every node is placed after its inputs
+  std::vector<Node*> Order(G.node_begin(), G.node_end());
+  auto Pos = [&](Node* N) {
+    return std::find(Order.begin(), Order.end(), N) - Order.begin();
+  };
+  EXPECT_LT(Pos(Const1), Pos(Sum));
+  EXPECT_LT(Pos(Sum), Pos(Ret));
+  EXPECT_LT(Pos(Func), Pos(Ret));
+  EXPECT_EQ(Order[SubGraph(End).node_size() - 1], End);
+}
+
+TEST(GraphUnitTest, TestRemoveNode) {
+  Graph G;
+  std::vector<Node*> Nodes;
+  Nodes.push_back(NodeBuilder<IrOpcode::Dead>(&G).Build());
+  for(auto i = 0U; i < 8U; ++i) {
+    auto* N = new (&G) Node(IrOpcode::Start, {}, {}, {});
+    G.InsertNode(N);
+    Nodes.push_back(N);
+  }
+
+  // remove every other node while iterating, tombstones
+  // are swept along the way
+  std::vector<Node*> Visited;
+  for(auto NI = G.node_begin(); NI != G.node_end();) {
+    Visited.push_back(Graph::GetNodeFromIt(NI));
+    if(Visited.size() % 2U)
+      ++NI;
+    else
+      NI = G.RemoveNode(NI);
+  }
+  EXPECT_EQ(Visited, Nodes);
+  EXPECT_EQ(G.node_size(), 5U);
+  // the last one is not swept yet
+  EXPECT_EQ(G.getNumDeadNodes(), 1U);
+  EXPECT_TRUE(Nodes[7]->IsRemoved());
+  EXPECT_EQ(G.getNodeById(Nodes[7]->getId()), nullptr);
+  EXPECT_EQ(G.getLastNode(), Nodes[8]);
+
+  G.MarkNodeDead(Nodes[8]);
+  EXPECT_EQ(G.getLastNode(), Nodes[6]);
+  EXPECT_EQ(G.getNodeById(Nodes[6]->getId()), Nodes[6]);
+  EXPECT_EQ(G.MaybeCollectDeadNodes(), 2U);
+  EXPECT_EQ(G.getLastNode(), Nodes[6]);
+  EXPECT_EQ(G.node_size(), 4U);
+}
+
+TEST(GraphUnitTest, TestCompact) {
+  Graph G;
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_compact")
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Garbage = NodeBuilder<IrOpcode::BinMul>(&G)
+                  .LHS(Const1).RHS(Const1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const2).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+  G.MarkNodeDead(Garbage);
+  // tombstones are not counted
+  auto NumNodes = G.node_size();
+  auto NumIds = G.getNumNodeIds();
+  EXPECT_EQ(NumIds, NumNodes + 1U);
+
+  auto Relocated = G.Compact(Graph::NodeOrder::RPO);
+  ASSERT_EQ(Relocated.size(), NumIds);
+  EXPECT_EQ(Relocated[Garbage->getId()], nullptr);
+  Const1 = Relocated[Const1->getId()];
+  Const2 = Relocated[Const2->getId()];
+  Sum = Relocated[Sum->getId()];
+  Ret = Relocated[Ret->getId()];
+  End = Relocated[End->getId()];
+  EXPECT_EQ(G.node_size(), NumNodes);
+  EXPECT_EQ(G.getNumNodeIds(), NumNodes);
+  EXPECT_EQ(G.getNumDeadNodes(), 0);
+
+  // ids are the positions, and nodes are laid out
+  // in the same order in memory
+  for(auto i = 0U; i < G.node_size(); ++i) {
+    auto* N = G.getNode(i);
+    EXPECT_EQ(N->getId(), i);
+    EXPECT_EQ(G.getNodeById(i), N);
+    if(i) {
+      EXPECT_LT(G.getNode(i - 1), N);
+    }
+  }
+  EXPECT_LT(Const1->getId(), Sum->getId());
+  EXPECT_LT(Sum->getId(), Ret->getId());
+  EXPECT_EQ(G.getNode(SubGraph(End).node_size() - 1), End);
+
+  // edges and side tables are rewired
+  EXPECT_EQ(Sum->getValueInput(0), Const1);
+  EXPECT_EQ(Sum->getValueInput(1), Const2);
+  ASSERT_EQ(Const1->user_size(), 1);
+  EXPECT_EQ(*Const1->users().begin(), Sum);
+  EXPECT_EQ(Ret->getValueInput(0), Sum);
+  EXPECT_EQ(NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build(), Const1);
+  EXPECT_EQ(G.node_size(), NumNodes);
+  ASSERT_EQ(G.node_size_of(IrOpcode::BinAdd), 1);
+  EXPECT_EQ(*G.nodes_of(IrOpcode::BinAdd).begin(), Sum);
+  // except the Dead node
+  EXPECT_EQ(G.subregions().begin()->node_size(), G.node_size() - 1);
+  EXPECT_EQ(*G.subregions().begin()->node_begin(), End);
+
+  // breadth-first from the tail node
+  Relocated = G.Compact(Graph::NodeOrder::BFS);
+  End = Relocated[End->getId()];
+  Ret = Relocated[Ret->getId()];
+  Sum = Relocated[Sum->getId()];
+  Const1 = Relocated[Const1->getId()];
+  EXPECT_EQ(G.getNode(0), End);
+  EXPECT_LT(Ret->getId(), Sum->getId());
+  EXPECT_LT(Sum->getId(), Const1->getId());
+  EXPECT_EQ(Sum->getValueInput(0), Const1);
+}
+
+TEST(GraphUnitTest, TestNodeMarker) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  {
+    // active markers don't interfere each other
+    NodeMarker<uint16_t> M1(G, 10000);
+    NodeMarker<uint16_t> M2(G, 10000);
+    M1.Set(Const1, 87);
+    M2.Set(Const1, 94);
+    EXPECT_EQ(M1.Get(Const1), 87);
+    EXPECT_EQ(M2.Get(Const1), 94);
+    EXPECT_EQ(M1.Get(Const2), 0);
+  }
+  {
+    // data from previous markers is invisible
+    NodeMarker<uint16_t> M(G, 10000);
+    EXPECT_EQ(M.Get(Const1), 0);
+  }
+  {
+    // more markers than slots, the extra ones
+    // fall back to side tables
+    std::vector<std::unique_ptr<NodeMarker<uint16_t>>> Markers;
+    for(auto i = 0U; i < Node::NumMarkerSlots + 3U; ++i) {
+      Markers.emplace_back(new NodeMarker<uint16_t>(G, 10000));
+      Markers.back()->Set(Const1, i + 1U);
+    }
+    for(auto i = 0U; i < Markers.size(); ++i) {
+      EXPECT_EQ(Markers[i]->Get(Const1), i + 1U);
+      EXPECT_EQ(Markers[i]->Get(Const2), 0);
+    }
+    // release one slot and take it again
+    Markers.front().reset();
+    Markers.front().reset(new NodeMarker<uint16_t>(G, 10000));
+    EXPECT_EQ(Markers.front()->Get(Const1), 0);
+    EXPECT_EQ(Markers.back()->Get(Const1), Markers.size());
+  }
+  // way more states than a single 32-bit range could offer
+  for(auto i = 0U; i < 500000U; ++i) {
+    NodeMarker<uint16_t> M(G, 10000);
+    EXPECT_EQ(M.Get(Const2), 0);
+    M.Set(Const2, 9999);
+  }
+}
+
+TEST(GraphUnitTest, TestNodeBiMap) {
+  Graph G;
+  std::vector<Node*> Nodes;
+  NodeBiMap<int32_t> Map;
+  // enough pairs to grow the tables several times
+  for(auto i = 0; i < 1000; ++i) {
+    Nodes.push_back(NodeBuilder<IrOpcode::ConstantInt>(&G, i).Build());
+    EXPECT_TRUE(Map.insert({Nodes.back(), i * 7}));
+  }
+  ASSERT_EQ(Map.size(), 1000U);
+  EXPECT_FALSE(Map.insert({Nodes[3], 5}));
+  EXPECT_EQ(Map.find_node(3 * 7), Nodes[3]);
+  ASSERT_NE(Map.find_value(Nodes[999]), nullptr);
+  EXPECT_EQ(*Map.find_value(Nodes[999]), 999 * 7);
+  EXPECT_EQ(Map.find_node(-1), nullptr);
+
+  for(auto i = 0U; i < 1000U; i += 2U)
+    Map.erase(Nodes[i]);
+  EXPECT_EQ(Map.size(), 500U);
+  for(auto i = 0; i < 1000; ++i) {
+    if(i % 2) {
+      EXPECT_EQ(Map.find_node(i * 7), Nodes[i]);
+      ASSERT_NE(Map.find_value(Nodes[i]), nullptr);
+      EXPECT_EQ(*Map.find_value(Nodes[i]), i * 7);
+    } else {
+      EXPECT_EQ(Map.find_node(i * 7), nullptr);
+      EXPECT_EQ(Map.find_value(Nodes[i]), nullptr);
+    }
+  }
+
+  // overwriting drops the stale pairs on both sides
+  EXPECT_TRUE(Map.insert({Nodes[1], 3 * 7}, true));
+  EXPECT_EQ(*Map.find_value(Nodes[1]), 3 * 7);
+  EXPECT_EQ(Map.find_node(1 * 7), nullptr);
+  EXPECT_TRUE(Map.insert({Nodes[5], 3 * 7}, true));
+  EXPECT_EQ(Map.find_value(Nodes[1]), nullptr);
+  EXPECT_EQ(Map.find_node(3 * 7), Nodes[5]);
+  EXPECT_EQ(Map.size(), 498U);
+}
+
+TEST(GraphUnitTest, TestConstantPayload) {
+  Graph G;
+  auto* Const = NodeBuilder<IrOpcode::ConstantInt>(&G, -94).Build();
+  EXPECT_EQ(NodeBuilder<IrOpcode::ConstantInt>(&G, -94).Build(), Const);
+  EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Const).as<int32_t>(), -94);
+
+  std::string Name("foo");
+  auto* Str = NodeBuilder<IrOpcode::ConstantStr>(&G, Name).Build();
+  Name = "bar";
+  EXPECT_EQ(NodeBuilder<IrOpcode::ConstantStr>(&G, "foo").Build(), Str);
+  EXPECT_NE(NodeBuilder<IrOpcode::ConstantStr>(&G, Name).Build(), Str);
+  // interned strings stay in place while the pool grows
+  for(auto i = 0U; i < 100U; ++i)
+    NodeBuilder<IrOpcode::ConstantStr>(&G, std::to_string(i)).Build();
+  EXPECT_EQ(NodeProperties<IrOpcode::ConstantStr>(Str).str(), "foo");
+  EXPECT_EQ(G.getNumConstStr(), 102U);
+}
+
+TEST(GraphUnitTest, TestNodesOfOpcode) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum1 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const1).RHS(Const2).Build();
+  auto* Sum2 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Sum1).RHS(Const2).Build();
+  auto* Sum3 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const1).RHS(Const1).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum2).Build();
+
+  auto ToVector = [](auto&& Range) {
+    return std::vector<Node*>(Range.begin(), Range.end());
+  };
+  EXPECT_EQ(ToVector(G.nodes_of(IrOpcode::BinAdd)),
+            (std::vector<Node*>{Sum1, Sum2, Sum3}));
+  EXPECT_EQ(G.node_size_of(IrOpcode::BinAdd), 3U);
+  EXPECT_EQ(G.node_size_of(IrOpcode::BinMul), 0U);
+  EXPECT_TRUE(G.nodes_of(IrOpcode::BinMul).begin() ==
+              G.nodes_of(IrOpcode::BinMul).end());
+
+  // only nodes in the function
+  SubGraph SG(Ret);
+  EXPECT_EQ(ToVector(SG.nodes_of(IrOpcode::BinAdd)),
+            (std::vector<Node*>{Sum2, Sum1}));
+  EXPECT_EQ(ToVector(SG.nodes_of(IrOpcode::Return)),
+            (std::vector<Node*>{Ret}));
+  EXPECT_TRUE(SG.nodes_of(IrOpcode::BinMul).begin() ==
+              SG.nodes_of(IrOpcode::BinMul).end());
+
+  // killed and removed nodes are dropped
+  auto* Dead = NodeBuilder<IrOpcode::Dead>(&G).Build();
+  for(auto* N : G.nodes_of(IrOpcode::BinAdd)) {
+    if(N == Sum1) N->Kill(Dead);
+  }
+  G.MarkNodeDead(Sum3);
+  EXPECT_EQ(ToVector(G.nodes_of(IrOpcode::BinAdd)),
+            (std::vector<Node*>{Sum2}));
+  EXPECT_EQ(ToVector(SG.nodes_of(IrOpcode::BinAdd)),
+            (std::vector<Node*>{Sum2}));
+}
+
+TEST(GraphUnitTest, TestNodeTable) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const2).Build();
+  auto* Garbage = NodeBuilder<IrOpcode::BinSub>(&G)
+                  .LHS(Const2).RHS(Const1).Build();
+
+  EXPECT_EQ(G.getNodeById(Sum->getId()), Sum);
+  EXPECT_EQ(std::vector<Node*>(Sum->inputs().begin(), Sum->inputs().end()),
+            (std::vector<Node*>{Const1, Const2}));
+  EXPECT_EQ(std::vector<Node*>(Const1->users().begin(),
+                               Const1->users().end()),
+            (std::vector<Node*>{Sum, Garbage}));
+
+  // edges are still resolved correctly after rewiring
+  Sum->ReplaceUseOfWith(Const2, Const1, Use::K_VALUE);
+  EXPECT_EQ(Sum->getValueInput(1), Const1);
+  EXPECT_EQ(Const1->user_size(), 3U);
+  EXPECT_EQ(Const2->user_size(), 1U);
+
+  auto GarbageId = Garbage->getId();
+  G.MarkNodeDead(Garbage);
+  G.CollectDeadNodes();
+  EXPECT_EQ(G.getNodeById(GarbageId), nullptr);
+  EXPECT_EQ(Const2->user_size(), 0U);
+  EXPECT_EQ(G.getNodeById(Sum->getId()), Sum);
+}
+
+TEST(GraphUnitTest, TestBulkReplaceWith) {
+  Graph G;
+  auto* From = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* To = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Other = NodeBuilder<IrOpcode::ConstantInt>(&G, 3).Build();
+  // both nodes have users of every kind
+  auto* N1 = new (&G) Node(IrOpcode::BinAdd, {From, Other}, {From}, {From});
+  G.InsertNode(N1);
+  auto* N2 = new (&G) Node(IrOpcode::BinAdd, {To, From}, {To}, {From, To});
+  G.InsertNode(N2);
+
+  From->ReplaceWith(To);
+  EXPECT_EQ(From->user_size(), 0U);
+  EXPECT_EQ(To->user_size(), 8U);
+  EXPECT_EQ(std::distance(To->value_users().begin(),
+                          To->value_users().end()), 3);
+  EXPECT_EQ(std::distance(To->control_users().begin(),
+                          To->control_users().end()), 2);
+  EXPECT_EQ(std::distance(To->effect_users().begin(),
+                          To->effect_users().end()), 3);
+  EXPECT_EQ(N1->getValueInput(0), To);
+  EXPECT_EQ(N1->getValueInput(1), Other);
+  EXPECT_EQ(N1->getControlInput(0), To);
+  EXPECT_EQ(N2->getValueInput(1), To);
+  EXPECT_EQ(N2->getEffectInput(0), To);
+
+  // use records are still consistent
+  N2->removeEffectInputAll(To);
+  N1->setControlInput(0, From);
+  EXPECT_EQ(To->user_size(), 5U);
+  EXPECT_EQ(std::distance(To->effect_users().begin(),
+                          To->effect_users().end()), 1);
+  EXPECT_EQ(*To->effect_users().begin(), N1);
+  ASSERT_EQ(From->user_size(), 1U);
+  EXPECT_EQ(*From->control_users().begin(), N1);
+
+  // only a single kind
+  To->ReplaceWith(From, Use::K_VALUE);
+  EXPECT_EQ(To->user_size(), 2U);
+  EXPECT_EQ(From->user_size(), 4U);
+  EXPECT_EQ(*To->effect_users().begin(), N1);
+  EXPECT_EQ(N2->getValueInput(0), From);
+  EXPECT_EQ(N2->getControlInput(0), To);
+}
+
+TEST(GraphUnitTest, TestCheckpointRollback) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const1).RHS(Const2).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+  auto NumNodes = G.node_size();
+  auto NumConsts = G.getNumConstNumber();
+
+  auto ToVector = [](auto&& Range) {
+    return std::vector<Node*>(Range.begin(), Range.end());
+  };
+
+  G.Checkpoint();
+  auto* Const3 = NodeBuilder<IrOpcode::ConstantInt>(&G, 3).Build();
+  auto* Mul = NodeBuilder<IrOpcode::BinMul>(&G)
+              .LHS(Sum).RHS(Const3).Build();
+  Ret->ReplaceUseOfWith(Sum, Mul, Use::K_VALUE);
+  Sum->setValueInput(1, Const1);
+  Sum->removeValueInputAll(Const1);
+  Sum->appendValueInput(Const3);
+  Const2->Kill(NodeBuilder<IrOpcode::Dead>(&G).Build());
+  EXPECT_TRUE(Const2->IsDead());
+  EXPECT_EQ(G.getNumConstNumber(), NumConsts + 1U);
+  G.Rollback();
+
+  EXPECT_FALSE(G.HasCheckpoint());
+  EXPECT_EQ(ToVector(Sum->inputs()), (std::vector<Node*>{Const1, Const2}));
+  EXPECT_EQ(Ret->getValueInput(0), Sum);
+  EXPECT_EQ(ToVector(Sum->users()), (std::vector<Node*>{Ret}));
+  EXPECT_EQ(ToVector(Const1->users()), (std::vector<Node*>{Sum}));
+  EXPECT_EQ(ToVector(Const2->users()), (std::vector<Node*>{Sum}));
+  EXPECT_FALSE(Const2->IsDead());
+  EXPECT_TRUE(Const3->IsRemoved());
+  EXPECT_TRUE(Mul->IsRemoved());
+  EXPECT_EQ(G.getNumConstNumber(), NumConsts);
+  EXPECT_EQ(ToVector(G.nodes_of(IrOpcode::ConstantInt)),
+            (std::vector<Node*>{Const1, Const2}));
+  EXPECT_EQ(G.node_size_of(IrOpcode::BinMul), 0U);
+  // the new constant is created again rather than revived
+  EXPECT_NE(NodeBuilder<IrOpcode::ConstantInt>(&G, 3).Build(), Const3);
+
+  // tombstones are only swept after the checkpoint is closed
+  G.Checkpoint();
+  EXPECT_EQ(G.CollectDeadNodes(), 0U);
+  G.Commit();
+  EXPECT_EQ(G.CollectDeadNodes(), 3U);
+  EXPECT_EQ(G.node_size(), NumNodes + 1U);
+
+  // nested checkpoints
+  G.Checkpoint();
+  G.Checkpoint();
+  Ret->ReplaceUseOfWith(Sum, Const1, Use::K_VALUE);
+  G.Commit();
+  EXPECT_EQ(Ret->getValueInput(0), Const1);
+  G.Rollback();
+  EXPECT_EQ(Ret->getValueInput(0), Sum);
+
+  G.Checkpoint();
+  Ret->ReplaceUseOfWith(Sum, Const1, Use::K_VALUE);
+  G.MarkNodeDead(Sum);
+  G.Commit();
+  EXPECT_EQ(Ret->getValueInput(0), Const1);
+  EXPECT_TRUE(Sum->IsRemoved());
+  EXPECT_EQ(G.CollectDeadNodes(), 1U);
+}
+
+TEST(GraphUnitTest, TestSpeculativeReduction) {
+  Graph G;
+  auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+               .FuncName("func_speculative")
+               .Build();
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+  auto* Const20 = NodeBuilder<IrOpcode::ConstantInt>(&G, 20).Build();
+  auto* Small = NodeBuilder<IrOpcode::BinAdd>(&G)
+                .LHS(Const1).RHS(Const2).Build();
+  auto* Large = NodeBuilder<IrOpcode::BinAdd>(&G)
+                .LHS(Const20).RHS(Const2).Build();
+  auto* Sum = NodeBuilder<IrOpcode::BinMul>(&G)
+              .LHS(Small).RHS(Large).Build();
+  auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Sum).Build();
+  Ret->appendControlInput(Func);
+  auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+              .AddTerminator(Ret)
+              .Build();
+  G.AddSubRegion(SubGraph(End));
+
+  // fold additions, but only keep the small results
+  struct SpeculativeFolder : public GraphEditor {
+    SpeculativeFolder(GraphEditor::Interface* editor)
+      : GraphEditor(editor) {}
+
+    GraphReduction Reduce(Node* N) {
+      if(N->getOp() != IrOpcode::BinAdd) return NoChange();
+      auto& G = GetGraph();
+      NodeProperties<IrOpcode::ConstantInt> LHS(N->getValueInput(0)),
+                                            RHS(N->getValueInput(1));
+      if(!LHS || !RHS) return NoChange();
+      auto Val = LHS.as<int32_t>() + RHS.as<int32_t>();
+      Checkpoint();
+      Replace(N, NodeBuilder<IrOpcode::ConstantInt>(&G, Val).Build());
+      if(Val > 10)
+        Rollback();
+      else
+        Commit();
+      return NoChange();
+    }
+
+    static constexpr
+    const char* name() { return "speculative-folder"; }
+  };
+
+  GraphReducer::RunWithEditor<SpeculativeFolder>(G);
+  ASSERT_FALSE(G.HasCheckpoint());
+  auto* Folded = Sum->getValueInput(0);
+  ASSERT_EQ(Folded->getOp(), IrOpcode::ConstantInt);
+  EXPECT_EQ(NodeProperties<IrOpcode::ConstantInt>(Folded).as<int32_t>(), 3);
+  EXPECT_EQ(Sum->getValueInput(1), Large);
+  EXPECT_FALSE(Large->IsDead());
+  EXPECT_EQ(Large->getValueInput(0), Const20);
+  EXPECT_EQ(G.getNumConstNumber(), 4U);
+}
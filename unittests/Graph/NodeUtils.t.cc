@@ -1,6 +1,8 @@
+#include "graphir/Graph/AttributeBuilder.h"
 #include "graphir/Graph/Graph.h"
 #include "graphir/Graph/NodeUtils.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 
 using namespace graphir;
 
@@ -178,3 +180,136 @@ TEST(NodeBuilderUnitTest, TestSrcDesigAccess) {
     EXPECT_EQ(AccessNode->getEffectInput(0), Dummy);
   }
 }
+
+TEST(NodeBuilderUnitTest, TestFunctionAttributes) {
+  Graph G;
+
+  auto* FuncNode = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+                   .FuncName("rem_sings")
+                   .Build();
+  AttributeBuilder AB(G);
+  EXPECT_TRUE(AB.empty());
+  AB.Add<Attr::IsBuiltin>().Add<Attr::HasSideEffect>();
+  EXPECT_FALSE(AB.empty());
+  EXPECT_TRUE(AB.hasAttr<Attr::IsBuiltin>());
+  EXPECT_FALSE(AB.hasAttr<Attr::NoMem>());
+  AB.Attach(FuncNode);
+  EXPECT_TRUE(AB.empty());
+
+  NodeProperties<IrOpcode::FunctionStub> NP(nullptr);
+  EXPECT_TRUE(NP.hasAttribute<Attr::IsBuiltin>(G, FuncNode));
+  EXPECT_TRUE(NP.hasAttribute<Attr::HasSideEffect>(G, FuncNode));
+  EXPECT_FALSE(NP.hasAttribute<Attr::NoMem>(G, FuncNode));
+  EXPECT_FALSE(NP.hasAttribute<Attr::ReadMem>(G, FuncNode));
+  EXPECT_FALSE(NP.hasAttribute<Attr::WriteMem>(G, FuncNode));
+}
+
+TEST(NodeBuilderUnitTest, TestValueNumbering) {
+  Graph G;
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+
+  // disabled by default
+  auto* Sum1 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const1).RHS(Const2).Build();
+  EXPECT_NE(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sum1);
+
+  G.SetValueNumbering(true);
+  auto* Sum2 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const1).RHS(Const2).Build();
+  EXPECT_EQ(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sum2);
+  // commutative
+  EXPECT_EQ(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const2).RHS(Const1).Build(), Sum2);
+  auto* Sub = NodeBuilder<IrOpcode::BinSub>(&G)
+              .LHS(Const1).RHS(Const2).Build();
+  EXPECT_NE(NodeBuilder<IrOpcode::BinSub>(&G)
+            .LHS(Const2).RHS(Const1).Build(), Sub);
+  EXPECT_EQ(NodeBuilder<IrOpcode::BinSub>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sub);
+
+  // stale entries are not used
+  Sum2->setValueInput(1, Const1);
+  auto* Sum3 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const1).RHS(Const2).Build();
+  EXPECT_NE(Sum3, Sum2);
+  auto* Dead = NodeBuilder<IrOpcode::Dead>(&G).Build();
+  Sum3->Kill(Dead);
+  EXPECT_NE(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sum3);
+
+  auto* Sum4 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const2).RHS(Const2).Build();
+  {
+    Graph::ValueNumberingScope NoGVN(G, false);
+    EXPECT_FALSE(G.IsValueNumbering());
+    EXPECT_NE(NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const2).RHS(Const2).Build(), Sum4);
+  }
+  EXPECT_TRUE(G.IsValueNumbering());
+  // numbers recorded before the scope survive it
+  EXPECT_EQ(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const2).RHS(Const2).Build(), Sum4);
+  EXPECT_EQ(NodeBuilder<IrOpcode::BinSub>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sub);
+}
+
+TEST(NodeBuilderUnitTest, TestValueNumberingFunctions) {
+  Graph G;
+  G.SetValueNumbering(true);
+  auto* Const1 = NodeBuilder<IrOpcode::ConstantInt>(&G, 1).Build();
+  auto* Const2 = NodeBuilder<IrOpcode::ConstantInt>(&G, 2).Build();
+
+  // (Const1 + Const2) * (Arg + Const1) in each of the functions
+  std::vector<Node*> ConstSums;
+  auto BuildFunc = [&](const std::string& Name) {
+    auto* Arg = NodeBuilder<IrOpcode::Argument>(&G, "a").Build();
+    auto* Func = NodeBuilder<IrOpcode::VirtFuncPrototype>(&G)
+                 .FuncName(Name)
+                 .AddParameter(Arg)
+                 .Build();
+    EXPECT_EQ(G.getValueNumberingFunction(), Func);
+    auto* ConstSum = NodeBuilder<IrOpcode::BinAdd>(&G)
+                     .LHS(Const1).RHS(Const2).Build();
+    EXPECT_EQ(NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Const2).RHS(Const1).Build(), ConstSum);
+    ConstSums.push_back(ConstSum);
+    auto* ArgSum = NodeBuilder<IrOpcode::BinAdd>(&G)
+                   .LHS(Arg).RHS(Const1).Build();
+    EXPECT_EQ(NodeBuilder<IrOpcode::BinAdd>(&G)
+              .LHS(Arg).RHS(Const1).Build(), ArgSum);
+    auto* Prod = NodeBuilder<IrOpcode::BinMul>(&G)
+                 .LHS(ConstSum).RHS(ArgSum).Build();
+    auto* Ret = NodeBuilder<IrOpcode::Return>(&G, Prod).Build();
+    Ret->appendControlInput(Func);
+    auto* End = NodeBuilder<IrOpcode::End>(&G, Func)
+                .AddTerminator(Ret)
+                .Build();
+    G.AddSubRegion(SubGraph(End));
+    return End;
+  };
+  auto* End1 = BuildFunc("func_value_numbering1");
+  auto* End2 = BuildFunc("func_value_numbering2");
+  EXPECT_NE(ConstSums[0], ConstSums[1]);
+
+  // functions only share global values
+  std::vector<Node*> Nodes1(SubGraph(End1).node_begin(),
+                            SubGraph(End1).node_end());
+  for(auto* N : SubGraph(End2).nodes()) {
+    if(std::find(Nodes1.begin(), Nodes1.end(), N) != Nodes1.end())
+      EXPECT_TRUE(NodeProperties<IrOpcode::VirtGlobalValues>(N));
+  }
+
+  // numbered within the function a pass is working on
+  G.SetValueNumberingFunction(End1);
+  auto* Sum1 = NodeBuilder<IrOpcode::BinAdd>(&G)
+               .LHS(Const1).RHS(Const2).Build();
+  EXPECT_NE(Sum1, ConstSums[0]);
+  EXPECT_EQ(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sum1);
+  G.SetValueNumberingFunction(End2);
+  EXPECT_NE(NodeBuilder<IrOpcode::BinAdd>(&G)
+            .LHS(Const1).RHS(Const2).Build(), Sum1);
+}